@@ -5,6 +5,7 @@ set(common_srcs
     ${COMMON_SRC_DIR}/dispatcher/jsonHandler.cpp
     ${COMMON_SRC_DIR}/dispatcher/handler/handshakeHandler.cpp
     ${COMMON_SRC_DIR}/dispatcher/handler/getInfoHandler.cpp
+    ${COMMON_SRC_DIR}/hal/time/time.cpp
     ${COMMON_SRC_DIR}/settings/settings.cpp
     ${COMMON_SRC_DIR}/logger/logger.cpp
     ${COMMON_SRC_DIR}/logger/loggerBase.cpp
@@ -19,16 +20,27 @@ set(common_srcs
     ${COMMON_SRC_DIR}/stream/fileOStream.cpp
     ${COMMON_SRC_DIR}/statemachine/mcuConnection.cpp
     ${COMMON_SRC_DIR}/statemachine/mcuConnectionFrontEnd.cpp
+    ${COMMON_SRC_DIR}/timer/inbox.cpp
     ${COMMON_SRC_DIR}/timer/intervalTimer.cpp
     ${COMMON_SRC_DIR}/timer/manager.cpp
     ${COMMON_SRC_DIR}/timer/timeoutTimer.cpp
+    ${COMMON_SRC_DIR}/timer/wheelManager.cpp
     ${COMMON_SRC_DIR}/utils/types.cpp
+    ${COMMON_SRC_DIR}/protocol/crc.cpp
+    ${COMMON_SRC_DIR}/protocol/frameEncoder.cpp
     ${COMMON_SRC_DIR}/protocol/frameHandler.cpp
+    ${COMMON_SRC_DIR}/protocol/framePool.cpp
+    ${COMMON_SRC_DIR}/protocol/linkNegotiator.cpp
+    ${COMMON_SRC_DIR}/protocol/packetAssembler.cpp
     ${COMMON_SRC_DIR}/protocol/packetHandler.cpp
+    ${COMMON_SRC_DIR}/protocol/receiveWindow.cpp
+    ${COMMON_SRC_DIR}/protocol/rttEstimator.cpp
+    ${COMMON_SRC_DIR}/protocol/stuffer.cpp
 )
 
 set(common_incs
     ${COMMON_SRC_DIR}/container/buffer.hpp
+    ${COMMON_SRC_DIR}/container/mpscQueue.hpp
     ${COMMON_SRC_DIR}/hal/fs/file.hpp
     ${COMMON_SRC_DIR}/hal/fs/filesystem.hpp
     ${COMMON_SRC_DIR}/hal/net/http/asyncHttpRequest.hpp
@@ -66,15 +78,31 @@ set(common_incs
     ${COMMON_SRC_DIR}/stream/fileBuffer.hpp
     ${COMMON_SRC_DIR}/stream/fileOStream.hpp
     ${COMMON_SRC_DIR}/stream/socketStream.hpp
+    ${COMMON_SRC_DIR}/timer/callback.hpp
+    ${COMMON_SRC_DIR}/timer/handle.hpp
     ${COMMON_SRC_DIR}/timer/IManager.hpp
+    ${COMMON_SRC_DIR}/timer/inbox.hpp
     ${COMMON_SRC_DIR}/timer/intervalTimer.hpp
     ${COMMON_SRC_DIR}/timer/ITimer.hpp
     ${COMMON_SRC_DIR}/timer/manager.hpp
     ${COMMON_SRC_DIR}/timer/timeoutTimer.hpp
+    ${COMMON_SRC_DIR}/timer/wheelManager.hpp
     ${COMMON_SRC_DIR}/utils/types.hpp
+    ${COMMON_SRC_DIR}/protocol/crc.hpp
     ${COMMON_SRC_DIR}/protocol/frame.hpp
     ${COMMON_SRC_DIR}/protocol/IFrame.hpp
+    ${COMMON_SRC_DIR}/protocol/ITransmitSource.hpp
+    ${COMMON_SRC_DIR}/protocol/frameEncoder.hpp
     ${COMMON_SRC_DIR}/protocol/frameHandler.hpp
+    ${COMMON_SRC_DIR}/protocol/frameView.hpp
+    ${COMMON_SRC_DIR}/protocol/framePool.hpp
+    ${COMMON_SRC_DIR}/protocol/limits.hpp
+    ${COMMON_SRC_DIR}/protocol/linkNegotiator.hpp
+    ${COMMON_SRC_DIR}/protocol/packetAssembler.hpp
     ${COMMON_SRC_DIR}/protocol/packetHandler.hpp
+    ${COMMON_SRC_DIR}/protocol/receiveWindow.hpp
+    ${COMMON_SRC_DIR}/protocol/rttEstimator.hpp
+    ${COMMON_SRC_DIR}/protocol/sliceFrame.hpp
+    ${COMMON_SRC_DIR}/protocol/stuffer.hpp
     ${COMMON_SRC_DIR}/protocol/messages/control.hpp
 )
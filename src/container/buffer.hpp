@@ -18,21 +18,25 @@ public:
     {
     }
 
+    // Full buffer keeps its data, new byte is dropped
     template <typename Type>
-    u16 write(Type ch)
+    bool write(Type ch)
     {
         std::lock_guard<std::mutex> lock(dataMutex_);
         return writeUnsafe(ch);
     }
 
+    // Returns number of bytes written, the rest didn't fit
     template <typename Type>
-    void write(gsl::span<const Type> str)
+    std::size_t write(gsl::span<const Type> str)
     {
         std::lock_guard<std::mutex> lock(dataMutex_);
+        std::size_t written = 0;
         for (int i = 0; i < str.length(); ++i)
         {
-            writeUnsafe(str[i]);
+            written += writeUnsafe(str[i]) ? 1 : 0;
         }
+        return written;
     }
 
     u8 getByte()
@@ -113,28 +117,21 @@ private:
     }
 
     template <typename Type>
-    u16 writeUnsafe(Type ch)
+    bool writeUnsafe(Type ch)
     {
+        if (size_ == BUF_SIZE)
+        {
+            return false;
+        }
         if (writerIndex_ >= BUF_SIZE)
         {
             writerIndex_ = 0;
         }
-        incrementSize();
+        ++size_;
         buffer_[writerIndex_++] = ch;
-        return writerIndex_;
+        return true;
     }
 
-    void incrementSize()
-    {
-        if (size_ < BUF_SIZE)
-        {
-            ++size_;
-        }
-        else
-        {
-            ++readerIndex_;
-        }
-    }
     u8 buffer_[BUF_SIZE];
     u16 writerIndex_;
     u16 readerIndex_;
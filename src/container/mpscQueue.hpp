@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace container
+{
+
+/* Bounded queue with many producers and one consumer, without locks (D. Vyukov's bounded
+ * queue with a single consumer). Producer claims a cell by moving the tail with compare and
+ * swap, then publishes it through the cell's sequence. Capacity is rounded up to power of 2.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+    explicit MpscQueue(std::size_t capacity)
+        : mask_(roundUp(capacity) - 1), cells_(new Cell[mask_ + 1]), tail_{0}, head_{0}
+    {
+        for (std::size_t i = 0; i <= mask_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue(const MpscQueue&&) = delete;
+    MpscQueue& operator=(const MpscQueue&&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread, false when queue is full
+    bool push(T&& value)
+    {
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells_[position & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            if (sequence == position)
+            {
+                if (tail_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (sequence < position)
+            {
+                // consumer didn't free the cell since last lap
+                return false;
+            }
+            else
+            {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only, false when queue is empty or the oldest value isn't published yet
+    bool pop(T& value)
+    {
+        Cell& cell = cells_[head_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1)
+        {
+            return false;
+        }
+        value = std::move(cell.value);
+        cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    // Consumer only, values claimed by producers including those not published yet
+    std::size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_;
+    }
+
+    std::size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    // keeps producers' and consumer's index in separate cache lines
+    static const std::size_t CacheLine = 64;
+
+    static std::size_t roundUp(std::size_t capacity)
+    {
+        std::size_t rounded = 1;
+        while (rounded < capacity)
+        {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    char padding_[CacheLine];
+    std::atomic<std::size_t> tail_;
+    char tailPadding_[CacheLine - sizeof(std::atomic<std::size_t>)];
+    std::size_t head_;
+};
+
+} // namespace container
@@ -141,6 +141,11 @@ void TcpClient::setHandler(const handler::ReaderCallback& reader)
     tcpClientImpl_->setHandler(reader);
 }
 
+void TcpClient::process()
+{
+    // handler is called from onData callback
+}
+
 } // namespace net
 } // namespace hal
 } // namespace socket
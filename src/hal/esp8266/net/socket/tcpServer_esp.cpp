@@ -20,6 +20,10 @@ TcpServer::~TcpServer() = default;
 void TcpServer::setHandler(const handler::ReaderCallback& reader)
 {
 }
+
+void TcpServer::process()
+{
+}
 } // namespace socket
 } // namespace net
 } // namespace hal
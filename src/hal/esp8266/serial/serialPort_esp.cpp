@@ -58,6 +58,19 @@ void SerialPort::setHandler(const handler::ReaderCallback& readerCallback)
     readerCallback_ = readerCallback;
 }
 
+void SerialPort::setBaudrate(int baudrate)
+{
+    // pending transmission would be sent with new speed
+    Serial.flush();
+    serialWrapper_->baudrate_ = baudrate;
+    Serial.updateBaudRate(baudrate);
+}
+
+int SerialPort::baudrate() const
+{
+    return serialWrapper_->baudrate_;
+}
+
 void SerialPort::process()
 {
     DataBuffer buffer;
@@ -6,6 +6,10 @@ namespace hal
 {
 namespace time
 {
+namespace
+{
+volatile bool wokenUp = false;
+} // namespace
 
 void sleep(u32 seconds)
 {
@@ -22,5 +26,21 @@ void usleep(u32 microseconds)
     delayMicroseconds(microseconds);
 }
 
+void sleepUntilWoken(u32 milliseconds)
+{
+    // UART has no thread to wake us, it is polled every millisecond instead
+    const u32 start = millis();
+    while (!wokenUp && 0 == Serial.available() && millis() - start < milliseconds)
+    {
+        delay(1);
+    }
+    wokenUp = false;
+}
+
+void wakeUp()
+{
+    wokenUp = true;
+}
+
 } // namespace time
 } // namespace hal
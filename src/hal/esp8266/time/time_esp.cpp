@@ -1,13 +1,16 @@
 #include <Arduino.h>
 
+#include "hal/time/time.hpp"
+
 namespace hal
 {
 namespace time
 {
 
-u64 milliseconds()
+u64 steadyMicroseconds()
 {
-    return millis();
+    // micros() wraps after 71 minutes, idle loop may sleep longer than that
+    return micros64();
 }
 
 } // namespace time
@@ -32,6 +32,8 @@ public:
     void write(u8 byte) override;
 
     void setHandler(const ReaderCallback& reader) override;
+    // Calls handler with received data, on the calling thread
+    void process();
 
 private:
     class TcpClientImpl;
@@ -28,6 +28,8 @@ public:
     void stop();
 
     void setHandler(const ReaderCallback& reader) override;
+    // Calls handler with data received by every session, on the calling thread
+    void process();
 
     void write(const std::string& data) override
     {
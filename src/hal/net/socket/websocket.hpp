@@ -27,6 +27,8 @@ public:
     void stop();
 
     void setHandler(const ReaderCallback& handler) override;
+    // Calls handler with messages received by every connection, on the calling thread
+    void process();
 
 private:
     class WebSocketWrapper;
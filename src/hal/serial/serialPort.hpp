@@ -27,6 +27,10 @@ public:
 
     void setHandler(const ReaderCallback& readerCallback) override;
 
+    // Peer has to switch at the same time, bytes in flight are lost
+    void setBaudrate(int baudrate);
+    int baudrate() const;
+
     std::size_t isDataToRecive();
     void process();
     // void read(u8* buf, std::size_t length);
@@ -9,5 +9,11 @@ namespace time
 void sleep(u32 seconds);
 void msleep(u32 milliseconds);
 void usleep(u32 microseconds);
+
+// Sleeps until wakeUp() is called or data arrives, at most given time.
+// Wake up which comes while caller is not sleeping ends its next sleep at once.
+void sleepUntilWoken(u32 milliseconds);
+// Safe to call from I/O threads
+void wakeUp();
 } // namespace time
 } // namespace hal
@@ -0,0 +1,50 @@
+#include "hal/time/time.hpp"
+
+namespace hal
+{
+namespace time
+{
+namespace
+{
+Clock source = &steadyMicroseconds;
+u64 cachedNow = 0;
+} // namespace
+
+void setClock(Clock clock)
+{
+    source = nullptr != clock ? clock : &steadyMicroseconds;
+    tick();
+}
+
+u64 microseconds()
+{
+    return source();
+}
+
+u64 milliseconds()
+{
+    return source() / 1000;
+}
+
+void tick()
+{
+    cachedNow = source();
+}
+
+u64 now()
+{
+    return cachedNow;
+}
+
+u64 nowMilliseconds()
+{
+    return cachedNow / 1000;
+}
+
+u64 roundUpToMilliseconds(u64 microseconds)
+{
+    return (microseconds + 999) / 1000;
+}
+
+} // namespace time
+} // namespace hal
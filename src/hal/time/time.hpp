@@ -7,8 +7,29 @@ namespace hal
 namespace time
 {
 
+// Source of monotonic time in microseconds, counted from unspecified point
+using Clock = u64 (*)();
+
+// Platform's steady clock, changes of wall clock don't move it
+u64 steadyMicroseconds();
+
+// Replaces clock source, e.g. with simulated one, nullptr restores steady clock.
+// Cached time is refreshed from the new source.
+void setClock(Clock clock);
+
+// Read clock source
+u64 microseconds();
 u64 milliseconds();
 
+// Time cached by last tick(), so timers and protocol which run in one loop iteration share
+// one reading of the clock. Main loop ticks at start of each iteration, it is not meant for
+// other threads.
+void tick();
+u64 now();
+u64 nowMilliseconds();
+
+// Rounded up, waiting for that many milliseconds doesn't end before given time
+u64 roundUpToMilliseconds(u64 microseconds);
 
 } // namespace time
 } // namespace hal
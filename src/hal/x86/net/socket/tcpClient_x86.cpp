@@ -77,6 +77,14 @@ public:
         }
     }
 
+    void process()
+    {
+        if (session_)
+        {
+            session_->process();
+        }
+    }
+
 private:
     void stop()
     {
@@ -173,6 +181,11 @@ void TcpClient::setHandler(const ReaderCallback& reader)
     tcpClientImpl_->setHandler(reader);
 }
 
+void TcpClient::process()
+{
+    tcpClientImpl_->process();
+}
+
 } // namespace net
 } // namespace hal
 } // namespace socket
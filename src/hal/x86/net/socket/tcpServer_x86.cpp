@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -49,7 +50,10 @@ public:
 
     void stop()
     {
-        sessions_.clear();
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex_);
+            sessions_.clear();
+        }
 
         ioService_.stop();
         if (thread_.joinable())
@@ -60,6 +64,7 @@ public:
 
     void setHandler(const ReaderCallback& reader)
     {
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
         for (auto& session : sessions_)
         {
             if (session)
@@ -70,12 +75,22 @@ public:
         readerCallback_ = reader;
     }
 
+    void process()
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        for (auto& session : sessions_)
+        {
+            session->process();
+        }
+    }
+
 private:
     void doAccept()
     {
         acceptor_.async_accept(socket_, [this](boost::system::error_code error) {
             if (!error)
             {
+                std::lock_guard<std::mutex> lock(sessionsMutex_);
                 sessions_.push_back(
                     std::make_unique<TcpSession>(std::move(socket_), readerCallback_));
                 sessions_.back()->start();
@@ -89,7 +104,9 @@ private:
     io_service ioService_;
     tcp::socket socket_;
     tcp::acceptor acceptor_;
+    // accepted on I/O thread, processed on loop thread
     std::vector<std::unique_ptr<TcpSession>> sessions_;
+    std::mutex sessionsMutex_;
     std::thread thread_;
     ReaderCallback readerCallback_;
 };
@@ -117,6 +134,11 @@ void TcpServer::setHandler(const ReaderCallback& reader)
     tcpServerImpl_->setHandler(reader);
 }
 
+void TcpServer::process()
+{
+    tcpServerImpl_->process();
+}
+
 } // namespace net
 } // namespace hal
 } // namespace socket
@@ -1,10 +1,13 @@
 #include "hal/x86/net/socket/tcpSession.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <functional>
 
 #include <gsl/span>
 
+#include "hal/time/sleep.hpp"
+
 using namespace boost::asio;
 using boost::asio::ip::tcp;
 
@@ -37,37 +40,28 @@ tcp::socket& TcpSession::getSocket()
 
 void TcpSession::doWrite(const std::string& data)
 {
-    async_write(socket_, buffer(data), [this](boost::system::error_code error, std::size_t size) {
-        if (nullptr != error)
-        {
-            logger_.error() << "Write failed: " << error.message();
-        }
-    });
+    write(buffer(data));
 }
 
 void TcpSession::doWrite(const gsl::span<const u8>& buf)
 {
-    std::vector<u8> dataBuffer;
-    dataBuffer.resize(buf.length());
-    std::memcpy(&dataBuffer[dataBuffer.size() - buf.length()], buf.data(), buf.length());
-    async_write(socket_, buffer(dataBuffer, buf.length()),
-                [this](boost::system::error_code error, std::size_t size) {
-                    if (nullptr != error)
-                    {
-                        logger_.error() << "Write failed: " << error.message();
-                    }
-                });
+    write(buffer(buf.data(), buf.size()));
 }
 
 void TcpSession::doWrite(u8 byte)
 {
-    std::array<u8, 1> buf = {byte};
-    async_write(socket_, buffer(buf, 1), [this](boost::system::error_code error, std::size_t size) {
-        if (nullptr != error)
-        {
-            logger_.error() << "Write failed: " << error.message();
-        }
-    });
+    write(buffer(&byte, 1));
+}
+
+void TcpSession::write(const const_buffer& data)
+{
+    // written straight from caller's buffer, which is reused once this returns
+    boost::system::error_code error;
+    boost::asio::write(socket_, buffer(data), error);
+    if (error)
+    {
+        logger_.error() << "Write failed: " << error.message();
+    }
 }
 
 void TcpSession::disconnect()
@@ -99,10 +93,13 @@ void TcpSession::doRead()
 
         if (!error)
         {
-            std::lock_guard<std::mutex> safeCallback(readerCallbackMutex_);
-            readerCallback_(buffer_, [this](const BufferSpan& buffer) {
-                                doWrite(buffer);
-                            });
+            // handed over to process(), so protocol and timers run on one thread
+            const gsl::span<const u8> data(buffer_, tranferred_bytes);
+            if (received_.write(data) != tranferred_bytes)
+            {
+                logger_.error() << "Receive buffer full, data dropped";
+            }
+            hal::time::wakeUp();
             return doRead();
         }
 
@@ -113,10 +110,22 @@ void TcpSession::doRead()
 
 void TcpSession::setHandler(const ReaderCallback& reader)
 {
-    std::lock_guard<std::mutex> safeCallback(readerCallbackMutex_);
     readerCallback_ = reader;
 }
 
+void TcpSession::process()
+{
+    u8 data[BUF_SIZE];
+    std::size_t available = received_.size();
+    while (0 != available)
+    {
+        gsl::span<u8> chunk(data, std::min(available, sizeof(data)));
+        received_.getData(chunk);
+        readerCallback_(chunk, [this](const BufferSpan& buffer) { doWrite(buffer); });
+        available = received_.size();
+    }
+}
+
 } // namespace net
 } // namespace hal
 } // namespace socket
@@ -1,12 +1,12 @@
 #pragma once
 
 #include <memory>
-#include <mutex>
 #include <string>
 
 #include <boost/asio.hpp>
 #include <gsl/span>
 
+#include "container/buffer.hpp"
 #include "logger/logger.hpp"
 #include "utils/types.hpp"
 
@@ -39,15 +39,19 @@ public:
     void disconnect();
     bool connected();
     void setHandler(const ReaderCallback& reader);
+    // Calls handler with data received since last call, on the calling thread
+    void process();
 
 private:
     void doRead();
+    void write(const boost::asio::const_buffer& data);
 
     u8 buffer_[BUF_SIZE];
+    // filled by I/O thread, emptied by process()
+    container::Buffer<2 * BUF_SIZE> received_;
     boost::asio::ip::tcp::socket socket_;
     logger::Logger logger_;
     ReaderCallback readerCallback_;
-    std::mutex readerCallbackMutex_;
 };
 
 } // namespace net
@@ -1,6 +1,10 @@
 #include "hal/net/socket/websocket.hpp"
 
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <thread>
 
@@ -14,6 +18,7 @@
 #include "boost/beast/core/ostream.hpp"
 #include "boost/beast/http/field.hpp"
 #include "boost/beast/websocket/stream.hpp"
+#include "hal/time/sleep.hpp"
 #include "logger/logger.hpp"
 #include "utils/types.hpp"
 
@@ -77,6 +82,21 @@ public:
         connection& operator=(const connection&& other) = delete;
         connection& operator=(const connection& other) = delete;
 
+        // Stream is used only on its strand, caller waits for the write so data isn't copied
+        void write(const BufferSpan& data)
+        {
+            std::promise<error_code> written;
+            strand_.post([this, &data, &written]() {
+                ws_.async_write(boost::asio::buffer(data.data(), data.size()),
+                                strand_.wrap([&written](error_code ec) { written.set_value(ec); }));
+            });
+            const error_code ec = written.get_future().get();
+            if (ec)
+            {
+                fail("write", ec);
+            }
+        }
+
         // Called immediately after the connection is created.
         // We keep this separate from the constructor because
         // shared_from_this may not be called from constructors.
@@ -124,32 +144,13 @@ public:
             {
                 return fail("read", ec);
             }
-            // Write the received message back
+            // handed over to process(), so protocol and timers run on one thread
             std::stringstream ss;
             ss << boost::beast::buffers(buffer_.data());
-
-            parent_.handler_(BufferSpan{ reinterpret_cast<const u8*>(ss.str().c_str()), static_cast<u32>(ss.str().length()) }, // NOLINT
-                             [this](const BufferSpan& buffer) {
-                                 //  ws_.binary(ws_.got_binary());
-                                 ws_.async_write(boost::asio::buffer(buffer.data(), buffer.size()),
-                                                 strand_.wrap(std::bind(&connection::on_write,
-                                                                        shared_from_this(),
-                                                                        std::placeholders::_1)));
-                             });
-        }
-
-        // Called after the message write completes
-        void on_write(error_code ec)
-        {
-            if (nullptr != ec)
-            {
-                return fail("write", ec);
-            }
-
-            // Empty out the buffer. This is
-            // needed if we want to do another read.
-            //
+            const std::string message = ss.str();
+            parent_.receive(shared_from_this(), DataBuffer(message.begin(), message.end()));
             buffer_.consume(buffer_.size());
+            hal::time::wakeUp();
 
             do_read();
         }
@@ -181,6 +182,32 @@ public:
         handler_ = reader;
     }
 
+    // Called on I/O thread for every complete message
+    void receive(const std::shared_ptr<connection>& from, DataBuffer&& data)
+    {
+        std::lock_guard<std::mutex> lock(receivedMutex_);
+        received_.push_back(Message{from, std::move(data)});
+    }
+
+    void process()
+    {
+        std::deque<Message> messages;
+        {
+            std::lock_guard<std::mutex> lock(receivedMutex_);
+            messages.swap(received_);
+        }
+        for (const auto& message : messages)
+        {
+            const auto from = message.from.lock();
+            if (!from)
+            {
+                // connection closed before its message was handled
+                continue;
+            }
+            handler_(message.data, [&from](const BufferSpan& buffer) { from->write(buffer); });
+        }
+    }
+
     void fail(const std::string& what, error_code ec)
     {
         logger.error() << "duplo: " << what << " with: " << ec.message();
@@ -273,7 +300,16 @@ public:
     }
 
 protected:
+    struct Message
+    {
+        std::weak_ptr<connection> from;
+        DataBuffer data;
+    };
+
     ReaderCallback handler_;
+    // filled by I/O thread, emptied by process()
+    std::deque<Message> received_;
+    std::mutex receivedMutex_;
     boost::asio::io_service ios_;                         // The io_service, required
     tcp::socket sock_;                                    // Holds accepted connections
     tcp::endpoint ep_;                                    // The remote endpoint during accept
@@ -339,6 +375,11 @@ void WebSocket::setHandler(const ReaderCallback& handler)
     webSocketWrapper_->setHandler(handler);
 }
 
+void WebSocket::process()
+{
+    webSocketWrapper_->process();
+}
+
 void WebSocket::start()
 {
     webSocketWrapper_->start();
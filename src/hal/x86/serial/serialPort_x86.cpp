@@ -1,5 +1,6 @@
 #include "hal/serial/serialPort.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <thread>
@@ -12,6 +13,8 @@
 #include <boost/system/error_code.hpp>
 
 #include "container/buffer.hpp"
+#include "hal/time/sleep.hpp"
+#include "logger/logger.hpp"
 
 using namespace boost;
 using namespace boost::asio;
@@ -37,6 +40,9 @@ public:
     u8 rawBuffer_[1024];
     container::Buffer<2048> buffer_;
     ReaderCallback readerCallback_;
+    logger::Logger logger_;
+
+    void write(const const_buffer& data);
 
 private:
     void loop();
@@ -44,7 +50,8 @@ private:
 };
 
 SerialPort::SerialWrapper::SerialWrapper(const std::string& port, const int baudrate)
-    : serialPort_(ioService_), port_(port), baudrate_(baudrate), rawBuffer_{}
+    : serialPort_(ioService_), port_(port), baudrate_(baudrate), rawBuffer_{},
+      logger_("SerialPort")
 {
     try
     {
@@ -70,6 +77,17 @@ SerialPort::SerialWrapper::~SerialWrapper()
     serialPort_.close();
 }
 
+void SerialPort::SerialWrapper::write(const const_buffer& data)
+{
+    // write_some may take only part of the data, frame has to go out whole
+    boost::system::error_code error;
+    boost::asio::write(serialPort_, buffer(data), error);
+    if (error)
+    {
+        logger_.error() << "Write failed: " << error.message();
+    }
+}
+
 void SerialPort::SerialWrapper::loop()
 {
     serialPort_.async_read_some(
@@ -80,14 +98,16 @@ void SerialPort::SerialWrapper::loop()
 void SerialPort::SerialWrapper::readCallback(const boost::system::error_code& error,
                                              const u32 bytesTransferred)
 {
-    if (nullptr != error || bytesTransferred != 0u)
+    if (nullptr != error)
     {
         return;
     }
-    readerCallback_(BufferSpan{ rawBuffer_, bytesTransferred },
-                    [this](const BufferSpan& buffer) {
-                        serialPort_.write_some(boost::asio::buffer(buffer.data(), buffer.length()));
-                    });
+    // handed over to process(), so protocol and timers run on one thread
+    if (buffer_.write(gsl::span<const u8>(rawBuffer_, bytesTransferred)) != bytesTransferred)
+    {
+        logger_.error() << "Receive buffer full, data dropped";
+    }
+    hal::time::wakeUp();
     loop();
 }
 
@@ -111,21 +131,41 @@ void SerialPort::setHandler(const ReaderCallback& readerCallback)
 
 void SerialPort::write(const std::string& data)
 {
-    serialWrapper_->serialPort_.write_some(boost::asio::buffer(data));
+    serialWrapper_->write(boost::asio::buffer(data));
 }
 
 void SerialPort::write(const BufferSpan& buffer)
 {
-    serialWrapper_->serialPort_.write_some(boost::asio::buffer(buffer.data(), buffer.length()));
+    serialWrapper_->write(boost::asio::buffer(buffer.data(), buffer.length()));
 }
 
 void SerialPort::write(u8 byte)
 {
-    serialWrapper_->serialPort_.write_some(boost::asio::buffer(std::vector<u8>{byte}));
+    serialWrapper_->write(boost::asio::buffer(&byte, 1));
+}
+
+void SerialPort::setBaudrate(const int baudrate)
+{
+    serialWrapper_->baudrate_ = baudrate;
+    serialWrapper_->serialPort_.set_option(asio::serial_port_base::baud_rate(baudrate));
+}
+
+int SerialPort::baudrate() const
+{
+    return serialWrapper_->baudrate_;
 }
 
 void SerialPort::process()
 {
+    u8 data[sizeof(serialWrapper_->rawBuffer_)];
+    std::size_t available = serialWrapper_->buffer_.size();
+    while (0 != available)
+    {
+        gsl::span<u8> chunk(data, std::min(available, sizeof(data)));
+        serialWrapper_->buffer_.getData(chunk);
+        serialWrapper_->readerCallback_(chunk, [this](const BufferSpan& buffer) { write(buffer); });
+        available = serialWrapper_->buffer_.size();
+    }
 }
 
 // void SerialPort::read(u8* buf, std::size_t length)
@@ -1,12 +1,21 @@
 #include "hal/time/sleep.hpp"
 
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 namespace hal
 {
 namespace time
 {
+namespace
+{
+std::mutex wakeUpMutex;
+std::condition_variable wakeUpCondition;
+bool wokenUp = false;
+} // namespace
+
 void sleep(u32 seconds)
 {
     std::this_thread::sleep_for(std::chrono::seconds(seconds));
@@ -21,5 +30,22 @@ void usleep(u32 microseconds)
 {
     std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
 }
+
+void sleepUntilWoken(u32 milliseconds)
+{
+    std::unique_lock<std::mutex> lock(wakeUpMutex);
+    wakeUpCondition.wait_for(lock, std::chrono::milliseconds(milliseconds),
+                             []() { return wokenUp; });
+    wokenUp = false;
+}
+
+void wakeUp()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeUpMutex);
+        wokenUp = true;
+    }
+    wakeUpCondition.notify_one();
+}
 } // namespace time
 } // namespace hal
@@ -7,11 +7,11 @@ namespace hal
 namespace time
 {
 
-u64 milliseconds()
+u64 steadyMicroseconds()
 {
-    auto epoch = std::chrono::high_resolution_clock::from_time_t(0);
-    auto now = std::chrono::high_resolution_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(now - epoch).count();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
 }
 
 } // namespace time
@@ -31,13 +31,18 @@ int main()
 #include "hal/net/socket/tcpServer.hpp"
 #include "hal/serial/serialPort.hpp"
 #include "hal/time/sleep.hpp"
+#include "hal/time/time.hpp"
 #include "logger/fileLogger.hpp"
 #include "logger/logger.hpp"
 #include "logger/loggerConf.hpp"
 #include "logger/stdOutLogger.hpp"
 #include "message/messages.hpp"
+#include "protocol/frameHandler.hpp"
+#include "protocol/linkNegotiator.hpp"
+#include "protocol/packetHandler.hpp"
 #include "settings/settings.hpp"
 #include "statemachine/mcuConnectionFrontEnd.hpp"
+#include "timer/wheelManager.hpp"
 
 namespace
 {
@@ -49,6 +54,16 @@ dispatcher::Dispatcher dispatch;
 auto serialPort = std::make_shared<hal::serial::SerialPort>(
     settings::Settings::db()["serial"]["port"].as<char*>(), 9600);
 
+timer::WheelManager timerManager;
+protocol::FrameHandler linkHandler;
+// link starts at speed every MCU firmware understands and is upgraded after capability exchange
+protocol::LinkNegotiator linkNegotiator(linkHandler, timerManager, 9600,
+                                        {460800,
+                                         protocol::Capabilities::BasicFrames |
+                                             protocol::Capabilities::ExtendedFrames |
+                                             protocol::Capabilities::StuffedFrames,
+                                         0});
+
 const std::string& handlerName = "SerialHandler";
 
 logger::Logger mcuConnectionLogger("McuConnection");
@@ -74,6 +89,7 @@ void setup()
         }
     }
 
+    hal::time::tick();
     logger.info() << "System booting up";
     // jsonHandler->setConnection(serialPort);
 
@@ -87,16 +103,31 @@ void setup()
     // dispatch.addHandler(std::move(jsonHandler), handlerName);
 
     logger.info() << "Handlers setup finished";
+
+    linkHandler.setConnection(serialPort);
+    linkNegotiator.setBaudrateSetter([](u32 baudrate) { serialPort->setBaudrate(baudrate); });
+    linkNegotiator.setAgreementHandler([](const protocol::Capabilities& agreed) {
+        logger::Logger logger("Main");
+        logger.info() << "Link settled at " << std::to_string(agreed.maxBaudrate) << " baud";
+    });
+    linkNegotiator.negotiate();
 }
 
 void loop()
 {
     logger::Logger logger("loop");
+    // everything run below shares this reading of the clock
+    hal::time::tick();
+    // I/O threads only buffer received data, handlers and timers run here
     serialPort->process();
+    messageServer->process();
+    timerManager.run();
     // if (mcuSM.backend().is(boost::sml::state<statemachine::states::NotConnected>))
     // {
     //     logger.info() << "Process connect";
     //     mcuSM.connect();
     // }
-    hal::time::msleep(100);
+
+    // I/O threads wake us when data comes, otherwise there is nothing to do before next timer
+    hal::time::sleepUntilWoken(timerManager.timeToNextDeadline());
 }
@@ -7,10 +7,21 @@
 namespace protocol
 {
 
+class FramePool;
+class IFrame;
+
+// Returns frame to pool it was allocated from, frames created with new are deleted
+struct FrameDeleter
+{
+    void operator()(IFrame* frame) const;
+
+    FramePool* pool = nullptr;
+};
+
 class IFrame
 {
 public:
-    using FramePtr = std::unique_ptr<IFrame>;
+    using FramePtr = std::unique_ptr<IFrame, FrameDeleter>;
 
     IFrame() = default;
     virtual ~IFrame() = default;
@@ -26,11 +37,12 @@ public:
     virtual void control(u8 control) = 0;
     virtual u8 control() const = 0;
     virtual void clear() = 0;
-    virtual u8 payload(const u8* data, u8 length) = 0;
+    virtual u16 payload(const u8* data, u16 length) = 0;
     virtual const u8* payload() const = 0;
-    virtual u8 length() const = 0;
+    virtual u16 length() const = 0;
+    // CRC-16/ARC of payload, accumulated while payload is appended
     virtual u16 crc() const = 0;
-    virtual u8 payloadSize() const = 0;
+    virtual u16 payloadSize() const = 0;
 };
 
 } // namespace protocol
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+// Port which shares link with others. FrameHandler pulls frames from it when its turn comes.
+class ITransmitSource
+{
+public:
+    ITransmitSource() = default;
+    virtual ~ITransmitSource() = default;
+    ITransmitSource(const ITransmitSource&) = delete;
+    ITransmitSource(const ITransmitSource&&) = delete;
+    ITransmitSource& operator=(const ITransmitSource&&) = delete;
+    ITransmitSource& operator=(const ITransmitSource&) = delete;
+
+    // Bytes of payload of frame which would be sent next, 0 when there is nothing to send
+    virtual std::size_t nextFrameSize() = 0;
+    // Sends the frame with FrameHandler::send
+    virtual void sendNextFrame() = 0;
+};
+
+} // namespace protocol
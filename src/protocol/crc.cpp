@@ -0,0 +1,137 @@
+#include "protocol/crc.hpp"
+
+#if defined(X86_ARCH) && (defined(__x86_64__) || defined(__i386__))
+#define CRC_PCLMUL_AVAILABLE
+#define CRC_PCLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#include <immintrin.h>
+#endif
+
+namespace protocol
+{
+namespace crc
+{
+
+#ifdef CRC_PCLMUL_AVAILABLE
+
+namespace
+{
+
+const std::size_t PclmulMinimumLength = 64;
+const std::size_t PclmulBlockMask = 15;
+
+CRC_PCLMUL_TARGET inline __m128i load(const u8* address)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(address)); // NOLINT
+}
+
+CRC_PCLMUL_TARGET inline __m128i fold(__m128i value, __m128i constants, __m128i next)
+{
+    const __m128i low = _mm_clmulepi64_si128(value, constants, 0x00);
+    const __m128i high = _mm_clmulepi64_si128(value, constants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, low), next);
+}
+
+/* Folding constants for reflected CRC-32 (0x04c11db7) from Intel's
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+ * Expects a multiple of 16 bytes, at least 64, and the raw (not inverted) register.
+ */
+CRC_PCLMUL_TARGET u32 foldBlocks(u32 crc, const u8* data, std::size_t length)
+{
+    alignas(16) static const u64 k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const u64 k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const u64 k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const u64 poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x1 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = load(data + 16);
+    __m128i x3 = load(data + 32);
+    __m128i x4 = load(data + 48);
+    data += 64;
+    length -= 64;
+
+    __m128i constants = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2)); // NOLINT
+    while (length >= 64)
+    {
+        x1 = fold(x1, constants, load(data));
+        x2 = fold(x2, constants, load(data + 16));
+        x3 = fold(x3, constants, load(data + 32));
+        x4 = fold(x4, constants, load(data + 48));
+        data += 64;
+        length -= 64;
+    }
+
+    constants = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4)); // NOLINT
+    x1 = fold(x1, constants, x2);
+    x1 = fold(x1, constants, x3);
+    x1 = fold(x1, constants, x4);
+
+    while (length >= 16)
+    {
+        x1 = fold(x1, constants, load(data));
+        data += 16;
+        length -= 16;
+    }
+
+    // 128 -> 64 bits
+    __m128i x0 = _mm_clmulepi64_si128(x1, constants, 0x10);
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x0);
+
+    constants = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0)); // NOLINT
+    x0 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), constants, 0x00);
+    x1 = _mm_xor_si128(x1, x0);
+
+    // Barrett reduction to 32 bits
+    constants = _mm_load_si128(reinterpret_cast<const __m128i*>(poly)); // NOLINT
+    x0 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), constants, 0x10);
+    x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask), constants, 0x00);
+    x1 = _mm_xor_si128(x1, x0);
+
+    return static_cast<u32>(_mm_extract_epi32(x1, 1));
+}
+
+bool detectPclmul()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+} // namespace
+
+bool Pclmul::supported()
+{
+    static const bool supported = detectPclmul();
+    return supported;
+}
+
+u32 Pclmul::fold(u32 crc, const u8*& data, std::size_t& length)
+{
+    if (length < PclmulMinimumLength || !supported())
+    {
+        return crc;
+    }
+
+    const std::size_t blocks = length & ~PclmulBlockMask;
+    crc = foldBlocks(crc, data, blocks);
+    data += blocks; // NOLINT
+    length -= blocks;
+    return crc;
+}
+
+#else
+
+bool Pclmul::supported()
+{
+    return false;
+}
+
+u32 Pclmul::fold(u32 crc, const u8*& /*data*/, std::size_t& /*length*/)
+{
+    return crc;
+}
+
+#endif // CRC_PCLMUL_AVAILABLE
+
+} // namespace crc
+} // namespace protocol
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "utils/types.hpp"
+
+namespace protocol
+{
+namespace crc
+{
+
+#ifdef X86_ARCH
+const std::size_t DefaultSlices = 8;
+#else
+// slice-by-8 tables take 12kB of RAM on ESP8266, single table is enough there
+const std::size_t DefaultSlices = 1;
+#endif
+
+template <typename T, std::size_t SLICES>
+struct Table
+{
+    T data[SLICES][256];
+};
+
+template <typename T, T POLYNOMIAL, std::size_t SLICES>
+constexpr Table<T, SLICES> generateTable()
+{
+    Table<T, SLICES> table{};
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        T crc = static_cast<T>(i);
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1) ? static_cast<T>((crc >> 1) ^ POLYNOMIAL) : static_cast<T>(crc >> 1);
+        }
+        table.data[0][i] = crc;
+    }
+
+    for (std::size_t slice = 1; slice < SLICES; ++slice)
+    {
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            const T previous = table.data[slice - 1][i];
+            table.data[slice][i] = static_cast<T>((previous >> 8) ^ table.data[0][previous & 0xff]);
+        }
+    }
+    return table;
+}
+
+struct NoAccelerator
+{
+    template <typename T>
+    static T fold(T crc, const u8*& /*data*/, std::size_t& /*length*/)
+    {
+        return crc;
+    }
+};
+
+// Folds 16 byte blocks with carry-less multiplication when CPU supports it.
+// Consumes nothing for inputs shorter than 64 bytes or when PCLMULQDQ is missing.
+struct Pclmul
+{
+    static u32 fold(u32 crc, const u8*& data, std::size_t& length);
+    static bool supported();
+};
+
+/* CRC with reflected input and output, POLYNOMIAL is given in reflected form.
+ * Register is kept without final xor, so update() may be called with consecutive chunks.
+ */
+template <typename T, T POLYNOMIAL, T INIT, T XOR_OUT, typename Accelerator = NoAccelerator,
+          std::size_t SLICES = DefaultSlices>
+class ReflectedCrc
+{
+    static_assert(SLICES == 1 || SLICES == 8, "Only slice-by-1 and slice-by-8 are supported");
+    static_assert(sizeof(T) <= sizeof(u32), "CRC wider than 32 bits isn't supported");
+
+public:
+    using ValueType = T;
+
+    ReflectedCrc() : crc_(INIT)
+    {
+    }
+
+    ReflectedCrc& update(const BufferSpan& data)
+    {
+        crc_ = process(crc_, data.data(), static_cast<std::size_t>(data.size()));
+        return *this;
+    }
+
+    ReflectedCrc& update(u8 byte)
+    {
+        crc_ = static_cast<T>((crc_ >> 8) ^ table_.data[0][(crc_ ^ byte) & 0xff]);
+        return *this;
+    }
+
+    T value() const
+    {
+        return static_cast<T>(crc_ ^ XOR_OUT);
+    }
+
+    void reset()
+    {
+        crc_ = INIT;
+    }
+
+    static T calculate(const BufferSpan& data)
+    {
+        return static_cast<T>(process(INIT, data.data(), static_cast<std::size_t>(data.size())) ^
+                              XOR_OUT);
+    }
+
+private:
+    using Sliced = std::integral_constant<bool, (SLICES == 8)>;
+
+    static T process(T crc, const u8* data, std::size_t length)
+    {
+        crc = Accelerator::fold(crc, data, length);
+        return process(crc, data, length, Sliced{});
+    }
+
+    static T process(T crc, const u8* data, std::size_t length, std::false_type /*sliced*/)
+    {
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            crc = static_cast<T>((crc >> 8) ^ table_.data[0][(crc ^ data[i]) & 0xff]); // NOLINT
+        }
+        return crc;
+    }
+
+    static T process(T crc, const u8* data, std::size_t length, std::true_type /*sliced*/)
+    {
+        const auto& t = table_.data;
+        while (length >= 8)
+        {
+            // byte wise loads keep it endian and alignment agnostic, compilers merge them
+            const u32 low = (static_cast<u32>(data[0]) | static_cast<u32>(data[1]) << 8 |
+                             static_cast<u32>(data[2]) << 16 | static_cast<u32>(data[3]) << 24) ^
+                            crc;
+            const u32 high = static_cast<u32>(data[4]) | static_cast<u32>(data[5]) << 8 |
+                             static_cast<u32>(data[6]) << 16 | static_cast<u32>(data[7]) << 24;
+            crc = static_cast<T>(t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^
+                                 t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^ t[3][high & 0xff] ^
+                                 t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^
+                                 t[0][high >> 24]);
+            data += 8; // NOLINT
+            length -= 8;
+        }
+        return process(crc, data, length, std::false_type{});
+    }
+
+    static constexpr Table<T, SLICES> table_ = generateTable<T, POLYNOMIAL, SLICES>();
+
+    T crc_;
+};
+
+template <typename T, T POLYNOMIAL, T INIT, T XOR_OUT, typename Accelerator, std::size_t SLICES>
+constexpr Table<T, SLICES> ReflectedCrc<T, POLYNOMIAL, INIT, XOR_OUT, Accelerator, SLICES>::table_;
+
+// Parameters identical to CRCpp CRC_16_ARC() and CRC_32()
+using Crc16Arc = ReflectedCrc<u16, 0xa001, 0x0000, 0x0000>;
+using Crc32 = ReflectedCrc<u32, 0xedb88320, 0xffffffff, 0xffffffff, Pclmul>;
+
+} // namespace crc
+} // namespace protocol
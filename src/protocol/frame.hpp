@@ -2,17 +2,21 @@
 
 #include <array>
 #include <cstring>
-#include <limits>
-
-#include <CRC.h>
 
 #include "protocol/IFrame.hpp"
+#include "protocol/crc.hpp"
+#include "protocol/limits.hpp"
 #include "utils/types.hpp"
 
 namespace protocol
 {
 
-const u16 MaxPayloadSize = 247;
+// Payload limit of frames with 16 bit length field, bounds receive buffer of extended connection
+#ifdef X86_ARCH
+const u16 MaxExtendedPayloadSize = 4096;
+#else
+const u16 MaxExtendedPayloadSize = 1024;
+#endif
 
 enum FrameByte : u8
 {
@@ -21,11 +25,10 @@ enum FrameByte : u8
 };
 
 
+// Frames with payload above 255 bytes can be sent only over connection with extended frames
 template <u16 PAYLOAD_SIZE = MaxPayloadSize>
 class Frame : public IFrame
 {
-    static_assert((PAYLOAD_SIZE <= std::numeric_limits<u8>::max()), "Payload size must be < 256");
-
 public:
     using PayloadContainer = std::array<u8, PAYLOAD_SIZE>;
 
@@ -69,16 +72,18 @@ public:
         number_ = 0;
         length_ = 0;
         control_ = 0;
+        crc_.reset();
     }
 
-    u8 payload(const u8* data, u8 length) override
+    u16 payload(const u8* data, u16 length) override
     {
         if (length + length_ > PAYLOAD_SIZE)
         {
             length = PAYLOAD_SIZE - length_;
         }
 
-        std::memcpy(payload_.data(), data, length);
+        std::memcpy(payload_.data() + length_, data, length);
+        crc_.update(BufferSpan{data, length});
         length_ += length;
         return length;
     }
@@ -88,17 +93,17 @@ public:
         return payload_.data();
     }
 
-    u8 length() const override
+    u16 length() const override
     {
         return length_;
     }
 
     u16 crc() const override
     {
-        return CRC::Calculate(payload_.data(), length_, CRC::CRC_16_ARC());
+        return crc_.value();
     }
 
-    u8 payloadSize() const override
+    u16 payloadSize() const override
     {
         return PAYLOAD_SIZE;
     }
@@ -106,8 +111,9 @@ public:
 private:
     u8 port_;
     u8 number_;
-    u8 length_;
+    u16 length_;
     u8 control_;
+    crc::Crc16Arc crc_;
     PayloadContainer payload_;
 };
 
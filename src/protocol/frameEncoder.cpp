@@ -0,0 +1,44 @@
+#include "protocol/frameEncoder.hpp"
+
+#include <cstring>
+
+#include "serializer/serializer.hpp"
+
+namespace protocol
+{
+
+std::size_t encode(const IFrame& frame, const gsl::span<u8>& buffer, const bool extended)
+{
+    const u8 headerSize = extended ? ExtendedFrameHeaderSize : FrameHeaderSize;
+    const std::size_t size = headerSize + FrameOverhead - FrameHeaderSize + frame.length();
+    if (static_cast<std::size_t>(buffer.size()) < size || (!extended && frame.length() > 0xff))
+    {
+        return 0;
+    }
+
+    u8* data = buffer.data();
+    data[0] = FrameByte::Start;
+    data[LengthOffset] = static_cast<u8>(frame.length());
+    data[NumberOffset] = frame.number();
+    data[PortOffset] = frame.port();
+    data[ControlOffset] = frame.control();
+    if (extended)
+    {
+        data[ControlOffset] |= ExtendedLengthFlag;
+        data[LengthHighOffset] = static_cast<u8>(frame.length() >> 8);
+    }
+    std::memcpy(data + headerSize, frame.payload(), frame.length()); // NOLINT
+    serializer::serialize(data + headerSize + frame.length(), frame.crc()); // NOLINT
+    data[size - 1] = FrameByte::End; // NOLINT
+    return size;
+}
+
+ReplyFrame encodeReply(const messages::Control control, const u8 port, const u8 number)
+{
+    ReplyFrame reply = replyTemplate(control);
+    reply[NumberOffset] = number;
+    reply[PortOffset] = port;
+    return reply;
+}
+
+} // namespace protocol
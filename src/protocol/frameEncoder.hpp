@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+
+#include <gsl/span>
+
+#include "protocol/IFrame.hpp"
+#include "protocol/frame.hpp"
+#include "protocol/messages/control.hpp"
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+// start, length, number, port, control
+const u8 FrameHeaderSize = 5;
+// header, CRC and end byte
+const u8 FrameOverhead = FrameHeaderSize + 2 + 1;
+// Set in control byte of extended frame, high byte of length follows control
+const u8 ExtendedLengthFlag = 0x80;
+const u8 ExtendedFrameHeaderSize = FrameHeaderSize + 1;
+const u8 ExtendedFrameOverhead = FrameOverhead + 1;
+
+// byte positions in encoded frame
+const u8 LengthOffset = 1;
+const u8 NumberOffset = 2;
+const u8 PortOffset = 3;
+const u8 ControlOffset = 4;
+const u8 LengthHighOffset = 5;
+
+using ReplyFrame = std::array<u8, FrameOverhead>;
+
+// CRC-16/ARC of empty payload is always 0, so only port and number differ between replies
+constexpr ReplyFrame replyTemplate(const messages::Control control)
+{
+    return ReplyFrame{{FrameByte::Start, 0, 0, 0, control, 0x00, 0x00, FrameByte::End}};
+}
+
+// Returns 0 when frame doesn't fit into buffer or its payload needs extended format
+std::size_t encode(const IFrame& frame, const gsl::span<u8>& buffer, bool extended = false);
+ReplyFrame encodeReply(messages::Control control, u8 port, u8 number);
+
+} // namespace protocol
@@ -1,24 +1,41 @@
 #include "protocol/frameHandler.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include <boost/core/ignore_unused.hpp>
 #include <gsl/span>
 
 #include "IFrame.hpp"
 #include "dispatcher/IDataReceiver.hpp"
 #include "frame.hpp"
+#include "protocol/crc.hpp"
+#include "protocol/frameEncoder.hpp"
 #include "protocol/messages/control.hpp"
+#include "protocol/stuffer.hpp"
 #include "serializer/serializer.hpp"
 
 namespace protocol
 {
 
 FrameHandler::FrameHandler()
-    : state_{State::IDLE}, rxCrcBytesReceived_{0}, rxLength_{0}, rxCrc_{0}, logger_("FrameHandler")
+    : rxFrame_(&rxBuffer_), txBuffer_(FRAME_SIZE + FrameOverhead), state_{State::IDLE},
+      extendedFrames_{false}, stuffing_{false}, rxOverflow_{false}, rxCrcBytesReceived_{0},
+      rxLength_{0}, rxCrc_{0}, duplicatesSuppressed_{0}, creditOverruns_{0}, timerManager_{nullptr},
+      delayedAckFrames_{0}, delayedAckTime_{0}, logger_("FrameHandler"), txBurst_{0},
+      txScheduling_{false}, txQuantumGranted_{false}
 {
 }
 
 FrameHandler::~FrameHandler()
 {
+    if (nullptr != timerManager_)
+    {
+        for (auto& receiver : ports_)
+        {
+            timerManager_->cancel(receiver.second.ack.timeout);
+        }
+    }
     if (connection_)
     {
         connection_->setHandler(&defaultReader);
@@ -36,22 +53,251 @@ void FrameHandler::setConnection(const dispatcher::IDataReceiver::RawDataReceive
 
 void FrameHandler::connect(const u16 port, const FrameReceiver& frameReceiver)
 {
-    if (receivers_.count(port) != 0)
+    if (ports_.count(port) != 0)
     {
         logger_.warn() << "Connection on port " << port << " exists.";
         return;
     }
 
-    receivers_[port] = frameReceiver;
+    ports_[port].callback = frameReceiver;
 }
 
-void FrameHandler::sendReply(const messages::Control status)
+void FrameHandler::disconnect(const u16 port)
 {
-    Frame<0> frame;
-    frame.port(rxBuffer_.port());
-    frame.number(rxBuffer_.number());
-    frame.control(status);
-    send(frame);
+    const auto entry = ports_.find(port);
+    if (entry == ports_.end())
+    {
+        return;
+    }
+
+    if (nullptr != timerManager_)
+    {
+        timerManager_->cancel(entry->second.ack.timeout);
+    }
+    const auto active = std::find(txActive_.begin(), txActive_.end(), port);
+    if (active != txActive_.end())
+    {
+        if (active == txActive_.begin())
+        {
+            txQuantumGranted_ = false;
+        }
+        txActive_.erase(active);
+    }
+    ports_.erase(entry);
+}
+
+void FrameHandler::setTransmitSource(const u16 port, ITransmitSource& source, const u8 weight)
+{
+    const auto entry = ports_.find(port);
+    if (entry == ports_.end())
+    {
+        logger_.warn() << "Transmit source set for not connected port " << port;
+        return;
+    }
+    entry->second.source = &source;
+    entry->second.weight = std::max<u8>(1, weight);
+}
+
+void FrameHandler::ready(const u16 port)
+{
+    const auto entry = ports_.find(port);
+    if (entry == ports_.end() || entry->second.source == nullptr)
+    {
+        logger_.warn() << "Port " << port << " without transmit source is ready";
+        return;
+    }
+
+    if (entry->second.active)
+    {
+        return;
+    }
+    // when others wait for burst, port joins the round served by pass after next read
+    const bool idle = txActive_.empty();
+    entry->second.active = true;
+    entry->second.deficit = 0;
+    txActive_.push_back(port);
+    if (idle)
+    {
+        schedule();
+    }
+}
+
+void FrameHandler::setTransmitBurst(const std::size_t bytes)
+{
+    txBurst_ = bytes;
+}
+
+void FrameHandler::setReceiveWindow(const u16 port, const u8 size, const Numbering numbering)
+{
+    const auto receiver = ports_.find(port);
+    if (receiver == ports_.end())
+    {
+        logger_.warn() << "Receive window set for not connected port " << port;
+        return;
+    }
+    receiver->second.window.resize(size);
+    receiver->second.numbering = numbering;
+}
+
+u32 FrameHandler::duplicatesSuppressed() const
+{
+    return duplicatesSuppressed_;
+}
+
+void FrameHandler::setDelayedAck(timer::IManager& timerManager, const u8 frames,
+                                 const u32 milliseconds)
+{
+    for (auto& receiver : ports_)
+    {
+        sendAck(receiver.first, receiver.second);
+    }
+    timerManager_ = frames < 2 ? nullptr : &timerManager;
+    delayedAckFrames_ = std::min<u8>(frames, CumulativeAckFrames);
+    delayedAckTime_ = milliseconds;
+}
+
+void FrameHandler::flushAck(const u16 port)
+{
+    const auto receiver = ports_.find(port);
+    if (receiver != ports_.end())
+    {
+        sendAck(port, receiver->second);
+    }
+}
+
+void FrameHandler::setReceiveCredit(const u16 port, const u16 bytes, const u16 longestFrame)
+{
+    const auto entry = ports_.find(port);
+    if (entry == ports_.end())
+    {
+        logger_.warn() << "Receive credit set for not connected port " << port;
+        return;
+    }
+    entry->second.creditLimit = bytes;
+    entry->second.credit = bytes;
+    entry->second.longestFrame = longestFrame;
+}
+
+void FrameHandler::releaseCredit(const u16 port, const u16 bytes)
+{
+    const auto entry = ports_.find(port);
+    if (entry == ports_.end() || entry->second.creditLimit == 0)
+    {
+        logger_.warn() << "Credit released on port " << port << " without flow control";
+        return;
+    }
+
+    Port& receiver = entry->second;
+    const u16 previous = receiver.credit;
+    receiver.credit = static_cast<u16>(
+        std::min<u32>(receiver.creditLimit, static_cast<u32>(receiver.credit) + bytes));
+    // Peer may wait for credit while it is below longest frame. Update is sent once it covers any
+    // frame, not for every few released bytes. Otherwise next ack carries the credit.
+    const u16 longestFrame = std::min(receiver.creditLimit, receiver.longestFrame);
+    if (previous < longestFrame && receiver.credit >= longestFrame)
+    {
+        sendCredit(port, receiver);
+    }
+}
+
+u16 FrameHandler::receiveCredit(const u16 port) const
+{
+    const auto entry = ports_.find(port);
+    return entry != ports_.end() ? entry->second.credit : 0;
+}
+
+u32 FrameHandler::creditOverruns() const
+{
+    return creditOverruns_;
+}
+
+void FrameHandler::setExtendedFrames(bool enabled)
+{
+    extendedFrames_ = enabled;
+    // frame in progress belongs to previous buffer
+    state_ = State::IDLE;
+    if (enabled)
+    {
+        if (!rxExtendedBuffer_)
+        {
+            rxExtendedBuffer_.reset(new Frame<MaxExtendedPayloadSize>());
+        }
+        rxFrame_ = rxExtendedBuffer_.get();
+        txBuffer_.resize(MaxExtendedPayloadSize + ExtendedFrameOverhead);
+        resizeStuffingBuffers();
+        return;
+    }
+
+    rxFrame_ = &rxBuffer_;
+    rxExtendedBuffer_.reset();
+    txBuffer_.resize(FRAME_SIZE + FrameOverhead);
+    txBuffer_.shrink_to_fit();
+    resizeStuffingBuffers();
+}
+
+bool FrameHandler::extendedFrames() const
+{
+    return extendedFrames_;
+}
+
+void FrameHandler::setStuffing(bool enabled)
+{
+    stuffing_ = enabled;
+    state_ = State::IDLE;
+    rxStuffed_.clear();
+    rxOverflow_ = false;
+    resizeStuffingBuffers();
+}
+
+bool FrameHandler::stuffing() const
+{
+    return stuffing_;
+}
+
+// Sized for longest frame once, so stuffing doesn't allocate per frame
+void FrameHandler::resizeStuffingBuffers()
+{
+    if (!stuffing_)
+    {
+        DataBuffer{}.swap(rxStuffed_);
+        DataBuffer{}.swap(rxUnstuffed_);
+        DataBuffer{}.swap(txStuffed_);
+        return;
+    }
+
+    const std::size_t stuffedSize = maxStuffedSize(txBuffer_.size()) + 1;
+    rxStuffed_.clear();
+    rxStuffed_.reserve(stuffedSize);
+    rxUnstuffed_.resize(txBuffer_.size());
+    txStuffed_.resize(stuffedSize);
+}
+
+void FrameHandler::sendReply(const messages::Control status, const FrameView& frame)
+{
+    if (!connection_)
+    {
+        logger_.error() << "Trying to send reply while connection aren't set";
+        return;
+    }
+
+    // Only data frames are answered. Reply to damaged reply could bounce between peers forever.
+    if (frame.control() != messages::Control::Transmission)
+    {
+        return;
+    }
+
+    const auto reply = encodeReply(status, frame.port(), frame.number());
+    write(BufferSpan{reply});
+}
+
+void FrameHandler::sendCreditReply(const Port& port, const FrameView& frame)
+{
+    u8 credit[sizeof(port.credit)];
+    serializer::serialize(static_cast<u8*>(credit), port.credit);
+    Frame<sizeof(credit)> reply(frame.port(), frame.number());
+    reply.control(messages::Control::Success);
+    reply.payload(static_cast<u8*>(credit), sizeof(credit));
+    send(reply);
 }
 
 void FrameHandler::onRead(const BufferSpan& buffer,
@@ -59,20 +305,106 @@ void FrameHandler::onRead(const BufferSpan& buffer,
 {
     boost::ignore_unused(writer);
 
-    for (auto i = 0; i < buffer.length(); ++i)
+    // ports which get ready while read is parsed are served together after it
+    txScheduling_ = true;
+    if (!stuffing_)
+    {
+        parse(buffer);
+    }
+    else
+    {
+        splitStuffed(buffer);
+    }
+    txScheduling_ = false;
+    schedule();
+}
+
+void FrameHandler::splitStuffed(const BufferSpan& buffer)
+{
+    const u8* data = buffer.data();
+    std::size_t remaining = buffer.size();
+    while (remaining != 0)
+    {
+        const auto* delimiter = static_cast<const u8*>(std::memchr(data, Delimiter, remaining));
+        const std::size_t chunk = delimiter != nullptr ? delimiter - data : remaining;
+        if (rxStuffed_.size() + chunk > rxStuffed_.capacity())
+        {
+            // delimiter was damaged or frame is too long, wait for next one
+            rxOverflow_ = true;
+            rxStuffed_.clear();
+        }
+        if (!rxOverflow_)
+        {
+            rxStuffed_.insert(rxStuffed_.end(), data, data + chunk); // NOLINT
+        }
+        if (delimiter == nullptr)
+        {
+            return;
+        }
+
+        if (rxOverflow_)
+        {
+            logger_.error() << "Stuffed frame exceeds receive buffer, dropped";
+        }
+        else if (!rxStuffed_.empty())
+        {
+            unstuffFrame();
+        }
+        rxStuffed_.clear();
+        rxOverflow_ = false;
+        data = delimiter + 1; // NOLINT
+        remaining -= chunk + 1;
+    }
+}
+
+void FrameHandler::unstuffFrame()
+{
+    const std::size_t size = unstuff(rxStuffed_, rxUnstuffed_);
+    if (size == 0)
+    {
+        logger_.error() << "Malformed stuffed frame dropped";
+        return;
+    }
+
+    // one stuffed block carries exactly one frame, rest of broken frame isn't awaited
+    state_ = State::IDLE;
+    parse(BufferSpan{rxUnstuffed_.data(), static_cast<BufferIndexType>(size)});
+    if (state_ != State::IDLE)
+    {
+        logger_.error() << "Incomplete stuffed frame dropped";
+        state_ = State::IDLE;
+    }
+}
+
+// State machine is entered only for frames split between reads, whole frames take fast path
+void FrameHandler::parse(const BufferSpan& buffer)
+{
+    for (BufferIndexType i = 0; i < buffer.length(); ++i)
     {
         switch (state_)
         {
             case State::IDLE:
             {
-                if (FrameByte::Start == buffer[i])
+                const auto* start = static_cast<const u8*>(
+                    std::memchr(&buffer[i], FrameByte::Start, buffer.length() - i));
+                if (start == nullptr)
+                {
+                    return;
+                }
+                i = start - buffer.data();
+
+                const std::size_t frameSize = parseComplete(start, buffer.length() - i);
+                if (frameSize != 0)
                 {
-                    rxLength_ = 0;
-                    rxCrcBytesReceived_ = 0;
-                    rxCrc_ = 0;
-                    rxBuffer_.clear();
-                    state_ = State::LENGTH_TRANSMISSION;
+                    i += frameSize - 1;
+                    break;
                 }
+
+                rxLength_ = 0;
+                rxCrcBytesReceived_ = 0;
+                rxCrc_ = 0;
+                rxFrame_->clear();
+                state_ = State::LENGTH_TRANSMISSION;
             }
             break;
 
@@ -85,41 +417,50 @@ void FrameHandler::onRead(const BufferSpan& buffer,
 
             case State::FRAME_NUMBER_TRANSMISSION:
             {
-                rxBuffer_.number(buffer[i]);
+                rxFrame_->number(buffer[i]);
                 state_ = State::PORT_TRANSMISSION;
             }
             break;
 
             case State::PORT_TRANSMISSION:
             {
-                rxBuffer_.port(buffer[i]);
+                rxFrame_->port(buffer[i]);
                 state_ = State::CONTROL_TRANSMISSION;
             }
             break;
 
             case State::CONTROL_TRANSMISSION:
             {
-                rxBuffer_.control(buffer[i]);
-                if (rxLength_ > 0)
+                rxFrame_->control(buffer[i] & ~ExtendedLengthFlag);
+                if (buffer[i] & ExtendedLengthFlag)
                 {
-                    state_ = State::PAYLOAD_TRANSMISSION;
+                    state_ = State::LENGTH_HIGH_TRANSMISSION;
                 }
                 else
                 {
-                    state_ = State::CRC_TRANSMISSION;
+                    startPayload();
                 }
             }
             break;
 
+            case State::LENGTH_HIGH_TRANSMISSION:
+            {
+                rxLength_ |= buffer[i] << 8;
+                startPayload();
+            }
+            break;
+
             case State::PAYLOAD_TRANSMISSION:
             {
-                u8 frameBytesToBeReceived = 0;
+                u16 frameBytesToBeReceived = 0;
 
                 // receive payload
                 if (rxLength_ != 0)
                 {
-                    frameBytesToBeReceived = buffer.length() - i > rxLength_ ? rxLength_ : buffer.length() - i;
-                    rxBuffer_.payload(&buffer[i], frameBytesToBeReceived);
+                    frameBytesToBeReceived = buffer.length() - i > rxLength_
+                                                 ? rxLength_
+                                                 : static_cast<u16>(buffer.length() - i);
+                    rxFrame_->payload(&buffer[i], frameBytesToBeReceived);
                     rxLength_ -= frameBytesToBeReceived;
                     i += frameBytesToBeReceived - 1;
                 }
@@ -143,39 +484,232 @@ void FrameHandler::onRead(const BufferSpan& buffer,
 
             case State::END_TRANSMISSION:
             {
-                if (0 == receivers_.count(rxBuffer_.port()))
-                {
-                    logger_.error() << "Handler for port " << std::to_string(rxBuffer_.port())
-                                    << " not exists.";
-                    sendReply(messages::Control::PortNotConnect);
-                }
-                else if (rxBuffer_.crc() != rxCrc_)
-                {
-                    logger_.error()
-                        << "CRC failed. Received " << rxCrc_ << " Expected: " << rxBuffer_.crc()
-                        << ", retranssmision requested";
-                    sendReply(messages::Control::CrcChecksumFailed);
-                }
-                else if (buffer[i] != FrameByte::End)
-                {
-                    logger_.error() << "Wrong end byte received";
-                    sendReply(messages::Control::WrongEndByte);
-                }
-                else
-                {
-                    if (rxBuffer_.control() == messages::Control::Transmission)
-                    {
-                        sendReply(messages::Control::Success);
-                    }
-                    receivers_.at(rxBuffer_.port())(rxBuffer_);
-                }
                 state_ = State::IDLE;
+                deliver(FrameView{rxFrame_->port(), rxFrame_->number(), rxFrame_->control(),
+                                  rxFrame_->payload(), rxFrame_->length(), rxFrame_->crc()},
+                        rxCrc_, buffer[i]);
             }
             break;
         }
     }
 }
 
+// Returns size of frame when it is whole in data, 0 when it has to go through state machine
+std::size_t FrameHandler::parseComplete(const u8* data, const std::size_t size)
+{
+    if (size < ExtendedFrameHeaderSize)
+    {
+        return 0;
+    }
+
+    u16 length = data[LengthOffset];
+    u8 headerSize = FrameHeaderSize;
+    const u8 control = data[ControlOffset];
+    if (control & ExtendedLengthFlag)
+    {
+        length |= data[LengthHighOffset] << 8;
+        headerSize = ExtendedFrameHeaderSize;
+    }
+    const std::size_t frameSize = headerSize + length + FrameOverhead - FrameHeaderSize;
+    // oversized frame is reported and dropped by state machine
+    if (frameSize > size || length > rxFrame_->payloadSize())
+    {
+        return 0;
+    }
+
+    const u8* payload = data + headerSize; // NOLINT
+    u16 crc;
+    serializer::deserialize(payload + length, crc); // NOLINT
+    deliver(FrameView{data[PortOffset], data[NumberOffset],
+                      static_cast<u8>(control & ~ExtendedLengthFlag), payload, length,
+                      crc::Crc16Arc::calculate(BufferSpan{payload, length})},
+            crc, data[frameSize - 1]);
+    return frameSize;
+}
+
+void FrameHandler::deliver(const FrameView& frame, const u16 receivedCrc, const u8 endByte)
+{
+    const auto receiver = ports_.find(frame.port());
+    if (receiver == ports_.end())
+    {
+        logger_.error() << "Handler for port " << std::to_string(frame.port()) << " not exists.";
+        sendReply(messages::Control::PortNotConnect, frame);
+    }
+    else if (frame.crc() != receivedCrc)
+    {
+        logger_.error() << "CRC failed. Received " << receivedCrc << " Expected: " << frame.crc()
+                        << ", retranssmision requested";
+        sendReply(messages::Control::CrcChecksumFailed, frame);
+    }
+    else if (endByte != FrameByte::End)
+    {
+        logger_.error() << "Wrong end byte received";
+        sendReply(messages::Control::WrongEndByte, frame);
+    }
+    else if (frame.control() == messages::Control::CreditRequest &&
+             receiver->second.creditLimit != 0)
+    {
+        sendCredit(frame.port(), receiver->second);
+    }
+    else if (frame.control() != messages::Control::Transmission)
+    {
+        receiver->second.callback(frame);
+    }
+    else
+    {
+        deliverData(frame, receiver->second);
+    }
+}
+
+void FrameHandler::deliverData(const FrameView& frame, Port& port)
+{
+    if (port.creditLimit != 0 && frame.length() > port.credit)
+    {
+        // as if receive buffer overflowed, peer retransmits frame after timeout
+        logger_.warn() << "Frame " << std::to_string(frame.number()) << " on port "
+                       << std::to_string(frame.port()) << " exceeds credit, dropped";
+        ++creditOverruns_;
+        return;
+    }
+
+    if (port.numbering == Numbering::PerPacket && frame.number() == 0)
+    {
+        // numbers of previous packet are reused by this one
+        port.window.restart();
+    }
+    // duplicate comes only when previous ack was lost, so it is acknowledged again
+    const bool accepted = port.window.accept(frame.number());
+    if (accepted && port.creditLimit != 0)
+    {
+        port.credit -= frame.length();
+    }
+
+    if (timerManager_ == nullptr && port.creditLimit != 0)
+    {
+        sendCreditReply(port, frame);
+    }
+    else if (timerManager_ == nullptr)
+    {
+        sendReply(messages::Control::Success, frame);
+    }
+    else
+    {
+        queueAck(frame.port(), port, frame.number());
+        if (!accepted)
+        {
+            // peer is already retransmitting, waiting longer would only repeat it
+            sendAck(frame.port(), port);
+        }
+    }
+
+    if (!accepted)
+    {
+        ++duplicatesSuppressed_;
+        return;
+    }
+    port.callback(frame);
+}
+
+void FrameHandler::queueAck(const u16 port, Port& receiver, const u8 number)
+{
+    PendingAck& ack = receiver.ack;
+    if (ack.bitmap != 0)
+    {
+        const u8 ahead = static_cast<u8>(number - ack.base);
+        const u8 behind = static_cast<u8>(ack.base - number);
+        // retransmitted frame fills hole in front of collected ones
+        if (behind < CumulativeAckFrames && ahead >= CumulativeAckFrames &&
+            (ack.bitmap >> (CumulativeAckFrames - behind)) == 0)
+        {
+            ack.bitmap <<= behind;
+            ack.base = number;
+        }
+        else if (ahead >= CumulativeAckFrames)
+        {
+            sendAck(port, receiver);
+        }
+    }
+
+    if (ack.bitmap == 0)
+    {
+        ack.base = number;
+        ack.frames = 0;
+        ack.timeout = timerManager_->arm(delayedAckTime_, [this, port]() { flushAck(port); });
+    }
+    ack.bitmap |= static_cast<u64>(1) << static_cast<u8>(number - ack.base);
+    if (++ack.frames >= delayedAckFrames_)
+    {
+        sendAck(port, receiver);
+    }
+}
+
+void FrameHandler::sendAck(const u16 port, Port& receiver)
+{
+    if (receiver.ack.bitmap == 0)
+    {
+        return;
+    }
+    timerManager_->cancel(receiver.ack.timeout);
+    writeAck(port, receiver);
+}
+
+// Credit goes out with collected acks, or alone when there are none
+void FrameHandler::sendCredit(const u16 port, Port& receiver)
+{
+    if (receiver.ack.bitmap != 0)
+    {
+        sendAck(port, receiver);
+        return;
+    }
+    writeAck(port, receiver);
+}
+
+void FrameHandler::writeAck(const u16 port, Port& receiver)
+{
+    PendingAck& ack = receiver.ack;
+    u8 payload[sizeof(receiver.credit) + sizeof(ack.bitmap)];
+    u8 offset = 0;
+    auto control = messages::Control::CumulativeAck;
+    if (receiver.creditLimit != 0)
+    {
+        serializer::serialize(static_cast<u8*>(payload), receiver.credit);
+        offset = sizeof(receiver.credit);
+        control = messages::Control::CreditUpdate;
+    }
+    serializer::serialize(&payload[offset], ack.bitmap);
+
+    // trailing zero bytes of bitmap are left out
+    u8 length = sizeof(payload);
+    while (length > offset && payload[length - 1] == 0)
+    {
+        --length;
+    }
+
+    Frame<sizeof(payload)> frame(static_cast<u8>(port), ack.bitmap != 0 ? ack.base : 0);
+    frame.control(control);
+    frame.payload(static_cast<u8*>(payload), length);
+    ack.bitmap = 0;
+    send(frame);
+}
+
+void FrameHandler::startPayload()
+{
+    if (rxLength_ > rxFrame_->payloadSize())
+    {
+        logger_.error() << "Frame with " << std::to_string(rxLength_)
+                        << " bytes of payload doesn't fit into receive buffer";
+        state_ = State::IDLE;
+    }
+    else if (rxLength_ > 0)
+    {
+        state_ = State::PAYLOAD_TRANSMISSION;
+    }
+    else
+    {
+        state_ = State::CRC_TRANSMISSION;
+    }
+}
+
 void FrameHandler::send(const IFrame& frame)
 {
     if (!connection_)
@@ -184,17 +718,96 @@ void FrameHandler::send(const IFrame& frame)
         return;
     }
 
-    connection_->write(FrameByte::Start);
-    connection_->write(frame.length());
-    connection_->write(frame.number());
-    connection_->write(frame.port());
-    connection_->write(frame.control());
-    connection_->write(BufferSpan{ frame.payload(), frame.payloadSize() });
-    u8 crc[2];
-    serializer::serialize(static_cast<u8*>(crc), frame.crc());
-    connection_->write(gsl::span<const u8>{crc});
-    connection_->write(FrameByte::End);
+    const std::size_t size = encode(frame, txBuffer_, extendedFrames_);
+    if (size == 0)
+    {
+        logger_.error() << "Frame with " << static_cast<int>(frame.length())
+                        << " bytes of payload doesn't fit into transmission buffer";
+        return;
+    }
+
+    write(BufferSpan{txBuffer_.data(), static_cast<BufferIndexType>(size)});
+}
+
+void FrameHandler::write(const BufferSpan& frame)
+{
+    if (!stuffing_)
+    {
+        connection_->write(frame);
+        return;
+    }
+
+    const std::size_t size = stuff(frame, txStuffed_);
+    txStuffed_[size] = Delimiter;
+    connection_->write(BufferSpan{txStuffed_.data(), static_cast<BufferIndexType>(size + 1)});
 }
 
+// Deficit round robin, sources which get ready during the pass are served by it
+void FrameHandler::schedule()
+{
+    if (txScheduling_ || txActive_.empty() || !connection_)
+    {
+        return;
+    }
+    txScheduling_ = true;
+
+    // longest frame of current format, so every port sends at least one frame per round
+    const std::size_t quantum = txBuffer_.size();
+    std::size_t written = 0;
+    while (!txActive_.empty() && (txBurst_ == 0 || written < txBurst_))
+    {
+        const u16 id = txActive_.front();
+        Port* port = &ports_.find(id)->second;
+        if (!txQuantumGranted_)
+        {
+            port->deficit += port->weight * quantum;
+            txQuantumGranted_ = true;
+        }
+
+        std::size_t size = port->source->nextFrameSize();
+        while (size != 0 && size + FrameOverhead <= port->deficit &&
+               (txBurst_ == 0 || written < txBurst_))
+        {
+            port->deficit -= size + FrameOverhead;
+            written += size + FrameOverhead;
+            port->source->sendNextFrame();
+            // sent frame may complete packet whose owner is destroyed and disconnects the port
+            const auto entry = ports_.find(id);
+            if (entry == ports_.end() || txActive_.empty() || txActive_.front() != id)
+            {
+                port = nullptr;
+                break;
+            }
+            port = &entry->second;
+            size = port->source->nextFrameSize();
+        }
+
+        if (nullptr == port)
+        {
+            // disconnect already took the port out of the round
+            continue;
+        }
+
+        if (size != 0 && size + FrameOverhead <= port->deficit)
+        {
+            // burst is spent in the middle of turn, port continues in next pass
+            break;
+        }
+
+        txActive_.pop_front();
+        txQuantumGranted_ = false;
+        if (size == 0)
+        {
+            // idle port doesn't collect credit
+            port->active = false;
+            port->deficit = 0;
+        }
+        else
+        {
+            txActive_.push_back(id);
+        }
+    }
+    txScheduling_ = false;
+}
 
 } // namespace protocol
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
+#include <deque>
 #include <functional>
 #include <map>
+#include <memory>
 
 #include <boost/sml.hpp>
 
@@ -9,19 +12,35 @@
 #include "dispatcher/IFrameHandler.hpp"
 #include "logger/logger.hpp"
 #include "protocol/IFrame.hpp"
+#include "protocol/ITransmitSource.hpp"
 #include "protocol/frame.hpp"
+#include "protocol/frameEncoder.hpp"
+#include "protocol/frameView.hpp"
 #include "protocol/messages/control.hpp"
+#include "protocol/receiveWindow.hpp"
 #include "statemachine/helper.hpp"
+#include "timer/IManager.hpp"
 
 #define FRAME_SIZE 255
 
 namespace protocol
 {
 
+// frames confirmed by single CumulativeAck, bits of its payload
+const u8 CumulativeAckFrames = 64;
+
 class FrameHandler
 {
 public:
-    using FrameReceiver = std::function<void(const IFrame& frame)>;
+    using FrameReceiver = std::function<void(const FrameView& frame)>;
+    // How peer numbers frames on port
+    enum class Numbering : u8
+    {
+        // modulo 256 across whole stream
+        Continuous,
+        // from 0 in each packet, as PacketHandler does
+        PerPacket
+    };
     FrameHandler();
     ~FrameHandler();
     FrameHandler(const FrameHandler&) = delete;
@@ -34,8 +53,78 @@ public:
     void send(const IFrame& frame);
 
     void connect(u16 port, const FrameReceiver& frameReceiver);
+    // Drops receiver, pending acks and transmit source of port
+    void disconnect(u16 port);
+
+    // Many ports share one link. Ports with frames ready are served by deficit round robin, in
+    // each round port may send frames up to weight times longest frame. Source must outlive port.
+    void setTransmitSource(u16 port, ITransmitSource& source, u8 weight = 1);
+    // Called by source when it has new frame to send
+    void ready(u16 port);
+    // Bytes written in one scheduling pass, 0 (default) writes every ready frame. Passes run after
+    // each read and when port gets ready on idle link, so frames waiting beyond burst are clocked
+    // by acks and newly ready port doesn't wait behind whole backlog of others.
+    void setTransmitBurst(std::size_t bytes);
+
+    // Frames which were already delivered are acknowledged again without delivery. Size 0, the
+    // default, disables window. With per packet numbering every header frame (number 0) is
+    // delivered and restarts the window, packet assembler recognises repeated headers itself.
+    void setReceiveWindow(u16 port, u8 size, Numbering numbering = Numbering::Continuous);
+    u32 duplicatesSuppressed() const;
+
+    // Received Transmission frames are confirmed together with one CumulativeAck after given
+    // number of frames or milliseconds, whichever comes first. Delay has to stay well below
+    // retransmission timeout of peer. Below 2 frames every frame is confirmed at once.
+    void setDelayedAck(timer::IManager& timerManager, u8 frames, u32 milliseconds);
+    // Sends acks collected on port without waiting, e.g. when last frame of packet came
+    void flushAck(u16 port);
+
+    // Credit based flow control of port. Peer may send bytes of payload, every received data frame
+    // takes its payload from the credit and receiver gives it back with releaseCredit once data
+    // is consumed. Acks carry current credit, frames above it are dropped without ack.
+    // Longest frame is the largest payload peer sends on port, update is sent once credit
+    // covers it again.
+    void setReceiveCredit(u16 port, u16 bytes, u16 longestFrame = MaxPayloadSize);
+    void releaseCredit(u16 port, u16 bytes);
+    u16 receiveCredit(u16 port) const;
+    u32 creditOverruns() const;
+
+    // Frames with 16 bit length are sent only when both peers support them. Extended frames up to
+    // MaxExtendedPayloadSize are received when enabled, otherwise ones which fit 255 bytes.
+    void setExtendedFrames(bool enabled);
+    bool extendedFrames() const;
+
+    // Frames are COBS stuffed and separated with Delimiter. Receiver resynchronises on next
+    // delimiter after damaged frame instead of searching for start byte inside payloads.
+    void setStuffing(bool enabled);
+    bool stuffing() const;
 
 protected:
+    // Frames confirmed by next CumulativeAck, bit i stands for frame base + i
+    struct PendingAck
+    {
+        u64 bitmap;
+        u8 base;
+        u8 frames;
+        timer::Handle timeout;
+    };
+
+    struct Port
+    {
+        FrameReceiver callback;
+        ReceiveWindow window;
+        Numbering numbering;
+        PendingAck ack;
+        ITransmitSource* source;
+        u8 weight;
+        bool active;
+        std::size_t deficit;
+        // credit is advertised only when limit is set
+        u16 creditLimit;
+        u16 credit;
+        u16 longestFrame;
+    };
+
     enum class State
     {
         IDLE,
@@ -43,26 +132,65 @@ protected:
         FRAME_NUMBER_TRANSMISSION,
         PORT_TRANSMISSION,
         CONTROL_TRANSMISSION,
+        LENGTH_HIGH_TRANSMISSION,
         PAYLOAD_TRANSMISSION,
         CRC_TRANSMISSION,
         END_TRANSMISSION
     };
 
-    void sendReply(messages::Control status);
+    void sendReply(messages::Control status, const FrameView& frame);
+    void sendCreditReply(const Port& port, const FrameView& frame);
     void onRead(const BufferSpan& buffer, const WriterCallback& writer);
-
+    void parse(const BufferSpan& buffer);
+    std::size_t parseComplete(const u8* data, std::size_t size);
+    void deliver(const FrameView& frame, u16 receivedCrc, u8 endByte);
+    void deliverData(const FrameView& frame, Port& port);
+    void queueAck(u16 port, Port& receiver, u8 number);
+    void sendAck(u16 port, Port& receiver);
+    void sendCredit(u16 port, Port& receiver);
+    void writeAck(u16 port, Port& receiver);
+    void splitStuffed(const BufferSpan& buffer);
+    void unstuffFrame();
+    void startPayload();
+    void write(const BufferSpan& frame);
+    void schedule();
+    void resizeStuffingBuffers();
+
+    // frames split between reads are assembled here
     Frame<FRAME_SIZE> rxBuffer_;
+    std::unique_ptr<Frame<MaxExtendedPayloadSize>> rxExtendedBuffer_;
+    IFrame* rxFrame_;
+    DataBuffer txBuffer_;
+    DataBuffer rxStuffed_;
+    DataBuffer rxUnstuffed_;
+    DataBuffer txStuffed_;
 
     State state_;
+    bool extendedFrames_;
+    bool stuffing_;
+    bool rxOverflow_;
 
     u8 rxCrcBytesReceived_;
-    u8 rxLength_;
+    u16 rxLength_;
     u16 rxCrc_;
+    u32 duplicatesSuppressed_;
+    u32 creditOverruns_;
+
+    timer::IManager* timerManager_;
+    u8 delayedAckFrames_;
+    u32 delayedAckTime_;
 
     logger::Logger logger_;
 
+    std::deque<u16> txActive_;
+    std::size_t txBurst_;
+    // set during pass and read, ready ports wait for pass which follows
+    bool txScheduling_;
+    // front port of txActive_ already got its quantum in current round
+    bool txQuantumGranted_;
+
     dispatcher::IDataReceiver::RawDataReceiverPtr connection_;
-    std::map<u16, FrameReceiver> receivers_;
+    std::map<u16, Port> ports_;
 };
 
 } // namespace protocol
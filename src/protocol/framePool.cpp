@@ -0,0 +1,78 @@
+#include "protocol/framePool.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace protocol
+{
+
+const std::size_t FramePool::DefaultFramesPerBlock = 8;
+
+void FrameDeleter::operator()(IFrame* frame) const
+{
+    if (pool == nullptr)
+    {
+        delete frame; // NOLINT
+        return;
+    }
+    pool->release(frame);
+}
+
+FramePool::FramePool(std::size_t slotSize, std::size_t framesPerBlock)
+    : slotSize_(slotSize),
+      slotsPerFrame_((slotSize + sizeof(Slot) - 1) / sizeof(Slot)),
+      framesPerBlock_(std::max<std::size_t>(1, framesPerBlock)),
+      capacity_{0}
+{
+}
+
+void FramePool::reserve(std::size_t frames)
+{
+    if (frames > free_.size())
+    {
+        const std::size_t missing = frames - free_.size();
+        grow((missing + framesPerBlock_ - 1) / framesPerBlock_ * framesPerBlock_);
+    }
+}
+
+std::size_t FramePool::capacity() const
+{
+    return capacity_;
+}
+
+std::size_t FramePool::available() const
+{
+    return free_.size();
+}
+
+void* FramePool::acquire()
+{
+    if (free_.empty())
+    {
+        grow(framesPerBlock_);
+    }
+
+    Slot* slot = free_.back();
+    free_.pop_back();
+    return slot;
+}
+
+void FramePool::release(IFrame* frame)
+{
+    frame->~IFrame();
+    // released slot always fits, free list has room for whole capacity
+    free_.push_back(reinterpret_cast<Slot*>(frame)); // NOLINT
+}
+
+void FramePool::grow(std::size_t frames)
+{
+    blocks_.emplace_back(new Slot[frames * slotsPerFrame_]);
+    capacity_ += frames;
+    free_.reserve(capacity_);
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        free_.push_back(&blocks_.back()[i * slotsPerFrame_]);
+    }
+}
+
+} // namespace protocol
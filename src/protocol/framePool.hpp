@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "protocol/IFrame.hpp"
+#include "protocol/frame.hpp"
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+/* Frames allocated from slots of fixed size in blocks, which are kept until pool is destroyed.
+ * Once pool grew to cover frames in use, allocation and release don't touch the heap.
+ * Pool must outlive all frames allocated from it.
+ */
+class FramePool
+{
+public:
+    static const std::size_t DefaultFramesPerBlock;
+
+    explicit FramePool(std::size_t slotSize = sizeof(Frame<MaxPayloadSize>),
+                       std::size_t framesPerBlock = DefaultFramesPerBlock);
+    ~FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool(const FramePool&&) = delete;
+    FramePool& operator=(const FramePool&&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    IFrame::FramePtr allocate()
+    {
+        return allocate<Frame<MaxPayloadSize>>();
+    }
+
+    // Frames bigger than slot are created on the heap
+    template <typename FrameType, typename... Args>
+    IFrame::FramePtr allocate(Args&&... args)
+    {
+        static_assert(std::is_base_of<IFrame, FrameType>::value, "Pool allocates only frames");
+        static_assert(alignof(FrameType) <= alignof(Slot), "Frame alignment above slot alignment");
+        if (sizeof(FrameType) > slotSize_)
+        {
+            return IFrame::FramePtr(new FrameType(std::forward<Args>(args)...));
+        }
+        void* slot = acquire();
+        return IFrame::FramePtr(new (slot) FrameType(std::forward<Args>(args)...),
+                                FrameDeleter{this});
+    }
+
+    // Makes sure that given number of frames may be allocated without growing
+    void reserve(std::size_t frames);
+
+    std::size_t capacity() const;
+    std::size_t available() const;
+
+protected:
+    friend struct FrameDeleter;
+
+    using Slot = std::aligned_storage<sizeof(std::max_align_t), alignof(std::max_align_t)>::type;
+
+    void* acquire();
+    void release(IFrame* frame);
+    void grow(std::size_t frames);
+
+    std::size_t slotSize_;
+    std::size_t slotsPerFrame_;
+    std::size_t framesPerBlock_;
+    std::vector<std::unique_ptr<Slot[]>> blocks_;
+    std::vector<Slot*> free_;
+    std::size_t capacity_;
+};
+
+} // namespace protocol
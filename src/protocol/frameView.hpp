@@ -0,0 +1,60 @@
+#pragma once
+
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+/* Received frame handed to receivers. Payload points into read buffer when frame came whole
+ * in one read, otherwise into receive buffer of FrameHandler. Valid only during the callback.
+ */
+class FrameView
+{
+public:
+    FrameView(u8 port, u8 number, u8 control, const u8* payload, u16 length, u16 crc)
+        : port_(port), number_(number), control_(control), length_(length), crc_(crc),
+          payload_(payload)
+    {
+    }
+
+    u8 port() const
+    {
+        return port_;
+    }
+
+    u8 number() const
+    {
+        return number_;
+    }
+
+    u8 control() const
+    {
+        return control_;
+    }
+
+    const u8* payload() const
+    {
+        return payload_;
+    }
+
+    u16 length() const
+    {
+        return length_;
+    }
+
+    // CRC-16/ARC of payload
+    u16 crc() const
+    {
+        return crc_;
+    }
+
+private:
+    u8 port_;
+    u8 number_;
+    u8 control_;
+    u16 length_;
+    u16 crc_;
+    const u8* payload_;
+};
+
+} // namespace protocol
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+const u16 MaxPayloadSize = 247;
+// 254 (max frames - header and CRC frame) * 247 (max payload in frame)
+const std::size_t MaxPacketSize = 62738;
+
+} // namespace protocol
@@ -0,0 +1,383 @@
+#include "protocol/linkNegotiator.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "protocol/frame.hpp"
+#include "protocol/messages/control.hpp"
+#include "serializer/serializer.hpp"
+
+namespace protocol
+{
+
+namespace
+{
+// version 1 carried window size after baudrate
+const u8 CapabilitiesVersion = 2;
+// version, max baudrate, frame formats, compression
+const u8 CapabilitiesSize = 7;
+const u8 RequestAttempts = 5;
+const u32 RequestTimeout = 500;
+// peer sends its response at old baudrate, so it switches after response leaves UART
+const u32 SwitchDelay = 50;
+const u8 CheckAttempts = 10;
+const u32 CheckInterval = 100;
+// longer than all checks of initiator, so both sides roll back when none got through
+const u32 CheckTimeout = 2 * CheckAttempts * CheckInterval;
+// formats which change framing, others may come from newer peers
+const u8 Framing =
+    Capabilities::BasicFrames | Capabilities::ExtendedFrames | Capabilities::StuffedFrames;
+} // namespace
+
+const u8 Capabilities::BasicFrames;
+const u8 Capabilities::ExtendedFrames;
+const u8 Capabilities::StuffedFrames;
+
+LinkNegotiator::LinkNegotiator(FrameHandler& handler, timer::IManager& timerManager,
+                               u32 baudrate, const Capabilities& capabilities)
+    : handler_(handler), timerManager_(timerManager), state_{State::Idle}, attempts_{0},
+      baudrate_(baudrate), previousBaudrate_(baudrate),
+      previousFrameFormats_(Capabilities::BasicFrames), local_(capabilities),
+      agreed_(capabilities), logger_("linkNegotiator")
+{
+    handler_.connect(LinkControlPort,
+                     std::bind(&LinkNegotiator::onFrame, this, std::placeholders::_1));
+}
+
+LinkNegotiator::~LinkNegotiator()
+{
+    timerManager_.cancel(timeout_);
+    handler_.disconnect(LinkControlPort);
+}
+
+void LinkNegotiator::setBaudrateSetter(const BaudrateSetter& setter)
+{
+    baudrateSetter_ = setter;
+}
+
+void LinkNegotiator::setAgreementHandler(const AgreementHandler& handler)
+{
+    agreementHandler_ = handler;
+}
+
+void LinkNegotiator::negotiate()
+{
+    state_ = State::Requesting;
+    attempts_ = RequestAttempts;
+    request();
+}
+
+bool LinkNegotiator::negotiating() const
+{
+    return state_ != State::Idle;
+}
+
+u32 LinkNegotiator::baudrate() const
+{
+    return baudrate_;
+}
+
+Capabilities LinkNegotiator::agree(const Capabilities& local, const Capabilities& remote)
+{
+    Capabilities agreed;
+    agreed.maxBaudrate = std::min(local.maxBaudrate, remote.maxBaudrate);
+    agreed.frameFormats =
+        static_cast<u8>((local.frameFormats & remote.frameFormats) | Capabilities::BasicFrames);
+    agreed.compression = static_cast<u8>(local.compression & remote.compression);
+    return agreed;
+}
+
+void LinkNegotiator::onFrame(const FrameView& frame)
+{
+    switch (frame.control())
+    {
+        case messages::Control::CapabilityRequest:
+            onRequest(frame);
+            break;
+        case messages::Control::CapabilityResponse:
+            onResponse(frame);
+            break;
+        case messages::Control::LinkCheck:
+            onCheck();
+            break;
+        case messages::Control::LinkCheckResponse:
+            onCheckResponse();
+            break;
+        case messages::Control::LinkConfirm:
+            onConfirm();
+            break;
+        case messages::Control::LinkConfirmResponse:
+            onConfirmResponse();
+            break;
+        default:
+            break;
+    }
+}
+
+namespace
+{
+
+bool deserialize(const FrameView& frame, Capabilities& capabilities)
+{
+    const u8* payload = frame.payload();
+    // newer versions may only append fields
+    if (frame.length() < CapabilitiesSize || payload[0] < CapabilitiesVersion)
+    {
+        return false;
+    }
+    serializer::deserialize(&payload[1], capabilities.maxBaudrate);
+    capabilities.frameFormats = payload[5];
+    capabilities.compression = payload[6];
+    return true;
+}
+
+} // namespace
+
+void LinkNegotiator::onRequest(const FrameView& frame)
+{
+    Capabilities remote;
+    if (!deserialize(frame, remote))
+    {
+        logger_.error() << "Wrong capability request";
+        return;
+    }
+
+    agreed_ = agree(local_, remote);
+    previousBaudrate_ = baudrate_;
+    previousFrameFormats_ = frameFormats();
+    sendCapabilities(messages::Control::CapabilityResponse);
+    if (agreed_.maxBaudrate == baudrate_)
+    {
+        awaitConfirmation();
+        return;
+    }
+
+    state_ = State::WaitingForCheck;
+    arm(SwitchDelay, [this]() {
+        switchBaudrate();
+        arm(CheckTimeout, [this]() { rollback(); });
+    });
+}
+
+void LinkNegotiator::onResponse(const FrameView& frame)
+{
+    Capabilities remote;
+    if (state_ != State::Requesting || !deserialize(frame, remote))
+    {
+        return;
+    }
+    timerManager_.cancel(timeout_);
+
+    agreed_ = agree(local_, remote);
+    previousBaudrate_ = baudrate_;
+    previousFrameFormats_ = frameFormats();
+    if (agreed_.maxBaudrate == baudrate_)
+    {
+        confirm();
+        return;
+    }
+
+    state_ = State::Checking;
+    attempts_ = CheckAttempts;
+    switchBaudrate();
+    check();
+}
+
+void LinkNegotiator::onCheck()
+{
+    // answered also while waiting for confirmation, answer to previous check could be lost
+    sendControl(messages::Control::LinkCheckResponse);
+    if (state_ == State::WaitingForCheck && baudrate_ == agreed_.maxBaudrate)
+    {
+        awaitConfirmation();
+    }
+}
+
+void LinkNegotiator::onCheckResponse()
+{
+    if (state_ == State::Checking)
+    {
+        timerManager_.cancel(timeout_);
+        confirm();
+    }
+}
+
+void LinkNegotiator::onConfirm()
+{
+    // answered also after settling, answer to previous confirmation could be lost
+    sendControl(messages::Control::LinkConfirmResponse);
+    if (state_ == State::WaitingForConfirmation)
+    {
+        timerManager_.cancel(timeout_);
+        finish();
+    }
+}
+
+void LinkNegotiator::onConfirmResponse()
+{
+    if (state_ == State::Confirming)
+    {
+        timerManager_.cancel(timeout_);
+        finish();
+    }
+}
+
+void LinkNegotiator::sendCapabilities(messages::Control control)
+{
+    u8 payload[CapabilitiesSize];
+    payload[0] = CapabilitiesVersion;
+    serializer::serialize(&payload[1], local_.maxBaudrate);
+    payload[5] = local_.frameFormats;
+    payload[6] = local_.compression;
+
+    Frame<CapabilitiesSize> frame(LinkControlPort, 0);
+    frame.control(control);
+    frame.payload(static_cast<u8*>(payload), sizeof(payload));
+    handler_.send(frame);
+}
+
+void LinkNegotiator::sendControl(messages::Control control)
+{
+    Frame<1> frame(LinkControlPort, 0);
+    frame.control(control);
+    handler_.send(frame);
+}
+
+void LinkNegotiator::request()
+{
+    sendCapabilities(messages::Control::CapabilityRequest);
+    arm(RequestTimeout, [this]() {
+        if (--attempts_ == 0)
+        {
+            logger_.warn() << "Peer doesn't answer capability request, link settings unchanged";
+            state_ = State::Idle;
+            return;
+        }
+        request();
+    });
+}
+
+void LinkNegotiator::check()
+{
+    sendControl(messages::Control::LinkCheck);
+    arm(CheckInterval, [this]() {
+        if (--attempts_ == 0)
+        {
+            rollback();
+            return;
+        }
+        check();
+    });
+}
+
+void LinkNegotiator::sendConfirm()
+{
+    sendControl(messages::Control::LinkConfirm);
+    arm(CheckInterval, [this]() {
+        if (--attempts_ == 0)
+        {
+            rollback();
+            return;
+        }
+        sendConfirm();
+    });
+}
+
+// Initiator switches frame format once it knows responder got the settings and confirms them in
+// it. Responder switched when it answered, so it reads only confirmation in the new format.
+void LinkNegotiator::confirm()
+{
+    if (unchanged())
+    {
+        finish();
+        return;
+    }
+
+    state_ = State::Confirming;
+    attempts_ = CheckAttempts;
+    applyFrameFormats(agreed_.frameFormats);
+    sendConfirm();
+}
+
+// Answer to request or check could be lost, then initiator goes back to previous settings.
+// Without confirmation responder goes back too.
+void LinkNegotiator::awaitConfirmation()
+{
+    if (unchanged())
+    {
+        timerManager_.cancel(timeout_);
+        finish();
+        return;
+    }
+
+    state_ = State::WaitingForConfirmation;
+    applyFrameFormats(agreed_.frameFormats);
+    arm(CheckTimeout, [this]() { rollback(); });
+}
+
+void LinkNegotiator::switchBaudrate()
+{
+    logger_.info() << "Switching baudrate to " << std::to_string(agreed_.maxBaudrate);
+    baudrate_ = agreed_.maxBaudrate;
+    if (baudrateSetter_)
+    {
+        baudrateSetter_(baudrate_);
+    }
+}
+
+void LinkNegotiator::rollback()
+{
+    logger_.warn() << "No traffic at " << std::to_string(baudrate_) << ", going back to "
+                   << std::to_string(previousBaudrate_);
+    agreed_.frameFormats = previousFrameFormats_;
+    if (baudrate_ != previousBaudrate_)
+    {
+        baudrate_ = previousBaudrate_;
+        if (baudrateSetter_)
+        {
+            baudrateSetter_(baudrate_);
+        }
+    }
+    finish();
+}
+
+void LinkNegotiator::finish()
+{
+    state_ = State::Idle;
+    agreed_.maxBaudrate = baudrate_;
+    applyFrameFormats(agreed_.frameFormats);
+    if (agreementHandler_)
+    {
+        agreementHandler_(agreed_);
+    }
+}
+
+bool LinkNegotiator::unchanged() const
+{
+    return baudrate_ == previousBaudrate_ &&
+           (agreed_.frameFormats & Framing) == previousFrameFormats_;
+}
+
+u8 LinkNegotiator::frameFormats() const
+{
+    return static_cast<u8>(Capabilities::BasicFrames |
+                           (handler_.extendedFrames() ? Capabilities::ExtendedFrames : 0) |
+                           (handler_.stuffing() ? Capabilities::StuffedFrames : 0));
+}
+
+void LinkNegotiator::applyFrameFormats(const u8 formats)
+{
+    if (formats != frameFormats())
+    {
+        handler_.setExtendedFrames((formats & Capabilities::ExtendedFrames) != 0);
+        handler_.setStuffing((formats & Capabilities::StuffedFrames) != 0);
+    }
+}
+
+void LinkNegotiator::arm(u32 milliseconds, timer::Callback callback)
+{
+    timerManager_.cancel(timeout_);
+    timeout_ = timerManager_.arm(milliseconds, std::move(callback));
+}
+
+} // namespace protocol
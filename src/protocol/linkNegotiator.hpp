@@ -0,0 +1,109 @@
+#pragma once
+
+#include <functional>
+
+#include "logger/logger.hpp"
+#include "protocol/frameHandler.hpp"
+#include "protocol/frameView.hpp"
+#include "protocol/messages/control.hpp"
+#include "timer/IManager.hpp"
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+const u16 LinkControlPort = 0;
+
+struct Capabilities
+{
+    static const u8 BasicFrames = 0x01;
+    static const u8 ExtendedFrames = 0x02;
+    static const u8 StuffedFrames = 0x04;
+
+    u32 maxBaudrate;
+    // bit masks, peers use what both of them support
+    u8 frameFormats;
+    u8 compression;
+};
+
+/* Exchanges capabilities with peer and moves link to the best settings both sides support.
+ * Window size isn't part of them, each PacketHandler negotiates its own with its peer.
+ * Baudrate is switched after exchange and checked with link check at new speed. Frame format
+ * is switched after that and initiator confirms the new settings, responder keeps them only when
+ * the confirmation comes. When check or confirmation doesn't get through, both sides go back to
+ * previous baudrate and frame format.
+ */
+class LinkNegotiator
+{
+public:
+    using BaudrateSetter = std::function<void(u32 baudrate)>;
+    // Called when settings are settled, baudrate is the one in use after possible rollback
+    using AgreementHandler = std::function<void(const Capabilities& agreed)>;
+
+    LinkNegotiator(FrameHandler& handler, timer::IManager& timerManager, u32 baudrate,
+                   const Capabilities& capabilities);
+    ~LinkNegotiator();
+    LinkNegotiator(const LinkNegotiator&) = delete;
+    LinkNegotiator(const LinkNegotiator&&) = delete;
+    LinkNegotiator& operator=(const LinkNegotiator&&) = delete;
+    LinkNegotiator& operator=(const LinkNegotiator&) = delete;
+
+    void setBaudrateSetter(const BaudrateSetter& setter);
+    void setAgreementHandler(const AgreementHandler& handler);
+
+    void negotiate();
+    bool negotiating() const;
+    u32 baudrate() const;
+
+    static Capabilities agree(const Capabilities& local, const Capabilities& remote);
+
+protected:
+    enum class State
+    {
+        Idle,
+        Requesting,
+        Checking,
+        WaitingForCheck,
+        // new settings applied, initiator confirms them and responder waits for the confirmation
+        Confirming,
+        WaitingForConfirmation
+    };
+
+    void onFrame(const FrameView& frame);
+    void onRequest(const FrameView& frame);
+    void onResponse(const FrameView& frame);
+    void onCheck();
+    void onCheckResponse();
+    void onConfirm();
+    void onConfirmResponse();
+    void sendCapabilities(messages::Control control);
+    void sendControl(messages::Control control);
+    void request();
+    void check();
+    void sendConfirm();
+    void confirm();
+    void awaitConfirmation();
+    void switchBaudrate();
+    bool unchanged() const;
+    u8 frameFormats() const;
+    void applyFrameFormats(u8 formats);
+    void rollback();
+    void finish();
+    void arm(u32 milliseconds, timer::Callback callback);
+
+    FrameHandler& handler_;
+    timer::IManager& timerManager_;
+    timer::Handle timeout_;
+    State state_;
+    u8 attempts_;
+    u32 baudrate_;
+    u32 previousBaudrate_;
+    u8 previousFrameFormats_;
+    Capabilities local_;
+    Capabilities agreed_;
+    BaudrateSetter baudrateSetter_;
+    AgreementHandler agreementHandler_;
+    logger::Logger logger_;
+};
+
+} // namespace protocol
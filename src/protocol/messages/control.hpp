@@ -1,20 +1,35 @@
-#pragma once
-
-#include "utils/types.hpp"
-
-namespace protocol
-{
-namespace messages
-{
-
-enum Control : u8
-{
-    Success = 0x20,
-    PortNotConnect = 0x21,
-    CrcChecksumFailed = 0x22,
-    WrongEndByte = 0x23,
-    Transmission = 0x24
-};
-
-} // namespace messages
+#pragma once
+
+#include "utils/types.hpp"
+
+namespace protocol
+{
+namespace messages
+{
+
+enum Control : u8
+{
+    Success = 0x20,
+    PortNotConnect = 0x21,
+    CrcChecksumFailed = 0x22,
+    WrongEndByte = 0x23,
+    Transmission = 0x24,
+    WindowSizeRequest = 0x25,
+    WindowSizeResponse = 0x26,
+    CapabilityRequest = 0x27,
+    CapabilityResponse = 0x28,
+    LinkCheck = 0x29,
+    LinkCheckResponse = 0x2a,
+    // number is the first confirmed frame, payload is bitmap of frames following it
+    CumulativeAck = 0x2b,
+    // payload is credit of port, i.e. bytes of payload receiver takes, then optional bitmap of
+    // confirmed frames as in CumulativeAck. Success may carry the credit as its payload too.
+    CreditUpdate = 0x2c,
+    CreditRequest = 0x2d,
+    // initiator got answer to link check in new settings, responder keeps them only after this
+    LinkConfirm = 0x2e,
+    LinkConfirmResponse = 0x2f
+};
+
+} // namespace messages
 } // namespace protocol
\ No newline at end of file
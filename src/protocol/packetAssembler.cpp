@@ -0,0 +1,162 @@
+#include "protocol/packetAssembler.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "protocol/crc.hpp"
+#include "protocol/frame.hpp"
+#include "protocol/limits.hpp"
+#include "serializer/serializer.hpp"
+
+namespace protocol
+{
+
+namespace
+{
+const u8 HeaderSize = 6;
+const u8 Crc32Size = 4;
+} // namespace
+
+PacketAssembler::PacketAssembler() : logger_("packetAssembler")
+{
+}
+
+void PacketAssembler::setReceiver(const PacketReceiver& receiver)
+{
+    receiver_ = receiver;
+}
+
+void PacketAssembler::append(u16 port, u8 frameNumber, const BufferSpan& payload)
+{
+    if (frameNumber == 0)
+    {
+        onHeader(port, payload);
+        return;
+    }
+
+    // frames of already finished packet, retransmitted because ack was lost
+    const auto active = activeMessages_.find(port);
+    if (active == activeMessages_.end())
+    {
+        return;
+    }
+
+    const Key packet = key(port, active->second);
+    auto& assembly = assemblies_.at(packet);
+    if (frameNumber <= assembly.dataFrames)
+    {
+        onData(port, assembly, frameNumber, payload);
+    }
+    else if (frameNumber == assembly.dataFrames + 1 && payload.size() == Crc32Size)
+    {
+        serializer::deserialize(payload.data(), assembly.crc);
+        assembly.crcReceived = true;
+    }
+    else
+    {
+        logger_.error() << "Unexpected frame " << std::to_string(frameNumber) << " on port "
+                        << std::to_string(port);
+        return;
+    }
+
+    if (assembly.missingFrames == 0 && assembly.crcReceived)
+    {
+        complete(port, packet);
+    }
+}
+
+std::size_t PacketAssembler::packetsInProgress() const
+{
+    return assemblies_.size();
+}
+
+PacketAssembler::Key PacketAssembler::key(u16 port, u8 messageNumber)
+{
+    return static_cast<Key>(port) << 8 | messageNumber;
+}
+
+void PacketAssembler::onHeader(u16 port, const BufferSpan& payload)
+{
+    if (payload.size() != HeaderSize)
+    {
+        logger_.error() << "Wrong header size: " << std::to_string(payload.size());
+        return;
+    }
+
+    u16 crc;
+    serializer::deserialize(payload.data() + 4, crc); // NOLINT
+    if (crc != crc::Crc16Arc::calculate(payload.subspan(0, 4)))
+    {
+        logger_.error() << "Header CRC mismatch";
+        return;
+    }
+
+    u16 size;
+    serializer::deserialize(payload.data(), size);
+    if (size > MaxPacketSize)
+    {
+        logger_.error() << "Packet size above max packet size: " << std::to_string(size);
+        return;
+    }
+
+    const u8 messageNumber = payload[2];
+    const auto active = activeMessages_.find(port);
+    if (active != activeMessages_.end())
+    {
+        // header retransmitted because ack was lost
+        if (active->second == messageNumber)
+        {
+            return;
+        }
+        // sender gave up previous packet
+        assemblies_.erase(key(port, active->second));
+    }
+
+    auto& assembly = assemblies_[key(port, messageNumber)];
+    assembly.data.resize(size);
+    assembly.dataFrames = static_cast<u8>((size + MaxPayloadSize - 1) / MaxPayloadSize);
+    assembly.missingFrames = assembly.dataFrames;
+    assembly.received.assign(assembly.dataFrames, false);
+    activeMessages_[port] = messageNumber;
+}
+
+void PacketAssembler::onData(u16 port, Assembly& assembly, u8 frameNumber,
+                             const BufferSpan& payload)
+{
+    const std::size_t offset = static_cast<std::size_t>(frameNumber - 1) * MaxPayloadSize;
+    const std::size_t expectedSize =
+        std::min<std::size_t>(MaxPayloadSize, assembly.data.size() - offset);
+    if (static_cast<std::size_t>(payload.size()) != expectedSize)
+    {
+        logger_.error() << "Frame " << std::to_string(frameNumber) << " on port "
+                        << std::to_string(port) << " has wrong size "
+                        << std::to_string(payload.size());
+        return;
+    }
+
+    if (assembly.received[frameNumber - 1])
+    {
+        return;
+    }
+    std::memcpy(assembly.data.data() + offset, payload.data(), expectedSize); // NOLINT
+    assembly.received[frameNumber - 1] = true;
+    --assembly.missingFrames;
+}
+
+void PacketAssembler::complete(u16 port, Key packet)
+{
+    activeMessages_.erase(port);
+    // packet is delivered from its buffer, which is released afterwards
+    const auto assembly = assemblies_.find(packet);
+    if (assembly->second.crc != crc::Crc32::calculate(assembly->second.data))
+    {
+        logger_.error() << "Packet CRC mismatch on port " << std::to_string(port);
+    }
+    else if (receiver_)
+    {
+        receiver_(port, assembly->second.data);
+    }
+    assemblies_.erase(assembly);
+}
+
+} // namespace protocol
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "logger/logger.hpp"
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+/* Reassembles packets from header frame, data frames and CRC-32 frame.
+ * Buffer of size announced in header is allocated once and every data frame is copied directly
+ * to its offset, so frames may come in any order. Packets are kept per port and message number.
+ * Data frames don't carry message number, on each port they belong to the packet which header
+ * came last.
+ */
+class PacketAssembler
+{
+public:
+    using PacketReceiver = std::function<void(u16 port, const BufferSpan& packet)>;
+
+    PacketAssembler();
+    ~PacketAssembler() = default;
+    PacketAssembler(const PacketAssembler&) = delete;
+    PacketAssembler(const PacketAssembler&&) = delete;
+    PacketAssembler& operator=(const PacketAssembler&&) = delete;
+    PacketAssembler& operator=(const PacketAssembler&) = delete;
+
+    void setReceiver(const PacketReceiver& receiver);
+
+    // Frame number 0 is header, next ones are data frames and the last one carries CRC-32
+    void append(u16 port, u8 frameNumber, const BufferSpan& payload);
+
+    std::size_t packetsInProgress() const;
+
+protected:
+    struct Assembly
+    {
+        Assembly() : dataFrames(0), missingFrames(0), crcReceived(false), crc(0)
+        {
+        }
+
+        DataBuffer data;
+        std::vector<bool> received;
+        u8 dataFrames;
+        u8 missingFrames;
+        bool crcReceived;
+        u32 crc;
+    };
+
+    using Key = u32;
+
+    static Key key(u16 port, u8 messageNumber);
+    void onHeader(u16 port, const BufferSpan& payload);
+    void onData(u16 port, Assembly& assembly, u8 frameNumber, const BufferSpan& payload);
+    void complete(u16 port, Key key);
+
+    std::map<Key, Assembly> assemblies_;
+    std::map<u16, u8> activeMessages_;
+    PacketReceiver receiver_;
+    logger::Logger logger_;
+};
+
+} // namespace protocol
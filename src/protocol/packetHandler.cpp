@@ -1,121 +1,802 @@
 #include "protocol/packetHandler.hpp"
 
+#include <algorithm>
 #include <functional>
-
-#include <CRC.h>
+#include <limits>
 
 #include "dispatcher/IDataReceiver.hpp"
+#include "hal/time/time.hpp"
+#include "protocol/crc.hpp"
 #include "protocol/frame.hpp"
 #include "protocol/messages/control.hpp"
+#include "protocol/sliceFrame.hpp"
 #include "serializer/serializer.hpp"
 #include "timer/IManager.hpp"
 
 namespace protocol
 {
 
+namespace
+{
+const u8 NegotiationAttempts = 5;
+const u8 HeaderSize = 6;
+const u8 Crc32Size = 4;
+const std::size_t SmallFrameSize = std::max(sizeof(SliceFrame), sizeof(Frame<HeaderSize>));
+const std::size_t DefaultHighPriorityQueueLimit = 4096;
+const std::size_t DefaultNormalPriorityQueueLimit = MaxPacketSize;
+} // namespace
 
 PacketHandler::PacketHandler(const u16 port,
                              const dispatcher::IDataReceiver::RawDataReceiverPtr& receiver,
                              timer::IManager& timerManager)
-    : txIndex_{0}, port_(port), rxMessageNumber_{0}, txMessageNumber_{0}, logger_("packetHandler"),
-      timerManager_(timerManager)
+    : PacketHandler(port, std::unique_ptr<FrameHandler>(new FrameHandler()), nullptr, timerManager)
 {
     handler_.setConnection(receiver);
+}
+
+PacketHandler::PacketHandler(const u16 port, FrameHandler& handler, timer::IManager& timerManager)
+    : PacketHandler(port, nullptr, &handler, timerManager)
+{
+}
+
+PacketHandler::PacketHandler(const u16 port, std::unique_ptr<FrameHandler> ownedHandler,
+                             FrameHandler* handler, timer::IManager& timerManager)
+    : ownedHandler_(std::move(ownedHandler)),
+      handler_(handler != nullptr ? *handler : *ownedHandler_),
+      smallFramePool_(SmallFrameSize),
+      txQueuedBytes_{{0, 0}},
+      txQueueLimits_{{DefaultHighPriorityQueueLimit, DefaultNormalPriorityQueueLimit}},
+      txInProgress_{false}, txBase_{0}, txNext_{0}, txLastAckAt_{0}, txInFlightBytes_{0},
+      peerCredited_{false}, peerCredit_{0}, creditStalled_{false}, creditStalls_{0}, windowSize_{1},
+      maxWindowSize_{1}, negotiationAttempts_{0}, retryLimit_{DefaultRetryLimit}, port_(port),
+      txMessageNumber_{0}, logger_("packetHandler"), timerManager_(timerManager)
+{
     handler_.connect(port, std::bind(&PacketHandler::onFrame, this, std::placeholders::_1));
+    handler_.setTransmitSource(port, *this);
+    assembler_.setReceiver([this](u16 /*port*/, const BufferSpan& packet) {
+        // sender waits for the last ack before it starts next packet
+        handler_.flushAck(port_);
+        if (packetReceiver_)
+        {
+            packetReceiver_(packet);
+        }
+    });
 }
 
+PacketHandler::~PacketHandler()
+{
+    // link and timer manager may outlive this handler, their callbacks capture it
+    for (auto& frame : txPacket_.frames)
+    {
+        timerManager_.cancel(frame.timeout);
+    }
+    timerManager_.cancel(negotiationTimeout_);
+    stopWaitingForCredit();
+    handler_.disconnect(port_);
+
+    // frames go back to pools before pools are destroyed
+    txPacket_.frames.clear();
+    for (auto& queue : txQueues_)
+    {
+        queue.clear();
+    }
+}
 
-void PacketHandler::send(const DataBuffer& data)
+SendStatus PacketHandler::send(const DataBuffer& data, Priority priority,
+                                const CompletionCallback& completion)
 {
-    if (data.size() >
-        62738) // 254 (max frames - start and control frame) * 247 (max payload in frame)
+    const auto status = admit(data.size(), priority, false);
+    if (status != SendStatus::Queued)
     {
-        logger_.error() << "Packet size above max packet size";
-        return;
+        return status;
+    }
+
+    auto& packet = enqueue(data.size(), priority, completion);
+    framePool_.reserve(packet.frameCount - 2);
+    smallFramePool_.reserve(1);
+
+    crc::Crc32 crc;
+    for (std::size_t offset = 0; offset < data.size(); offset += MaxPayloadSize)
+    {
+        const auto length =
+            static_cast<u8>(std::min<std::size_t>(MaxPayloadSize, data.size() - offset));
+        const BufferSpan slice{data.data() + offset, length}; // NOLINT
+        IFrame::FramePtr frame = framePool_.allocate();
+        frame->payload(slice.data(), length);
+        crc.update(slice);
+        appendFrame(packet, std::move(frame));
+    }
+    appendCrcFrame(packet, crc.value());
+
+    startPacket();
+    return SendStatus::Queued;
+}
+
+SendStatus PacketHandler::send(DataBuffer&& data, Priority priority,
+                                const CompletionCallback& completion)
+{
+    return send(std::make_shared<const DataBuffer>(std::move(data)), priority, completion);
+}
+
+SendStatus PacketHandler::send(const SharedBuffer& data, Priority priority,
+                                const CompletionCallback& completion)
+{
+    const auto status = admit(data->size(), priority, false);
+    if (status != SendStatus::Queued)
+    {
+        return status;
+    }
+
+    auto& packet = enqueue(data->size(), priority, completion);
+    packet.payload = data;
+    smallFramePool_.reserve(packet.frameCount - 1);
+
+    // frames are views into the buffer, payload is copied only when frame is encoded
+    crc::Crc32 crc;
+    for (std::size_t offset = 0; offset < data->size(); offset += MaxPayloadSize)
+    {
+        const auto length =
+            static_cast<u8>(std::min<std::size_t>(MaxPayloadSize, data->size() - offset));
+        const BufferSpan slice{data->data() + offset, length}; // NOLINT
+        crc.update(slice);
+        appendFrame(packet, smallFramePool_.allocate<SliceFrame>(slice.data(), length));
+    }
+    appendCrcFrame(packet, crc.value());
+
+    startPacket();
+    return SendStatus::Queued;
+}
+
+SendStatus PacketHandler::send(std::size_t size, const Producer& producer, Priority priority,
+                                const CompletionCallback& completion)
+{
+    const auto status = admit(size, priority, true);
+    if (status != SendStatus::Queued)
+    {
+        return status;
+    }
+
+    // data frames are produced when window reaches them
+    enqueue(size, priority, completion, producer);
+    startPacket();
+    return SendStatus::Queued;
+}
+
+void PacketHandler::setPacketReceiver(const PacketReceiver& receiver)
+{
+    packetReceiver_ = receiver;
+}
+
+void PacketHandler::setTransmitWeight(const u8 weight)
+{
+    handler_.setTransmitSource(port_, *this, weight);
+}
+
+void PacketHandler::setDelayedAck(const u8 frames, const u32 milliseconds)
+{
+    handler_.setDelayedAck(timerManager_, frames, milliseconds);
+}
+
+void PacketHandler::setFailureHandler(const FailureHandler& handler)
+{
+    failureHandler_ = handler;
+}
+
+void PacketHandler::setRetryLimit(u8 retries)
+{
+    retryLimit_ = retries;
+}
+
+void PacketHandler::setQueueLimit(Priority priority, std::size_t bytes)
+{
+    txQueueLimits_[static_cast<std::size_t>(priority)] = bytes;
+}
+
+std::size_t PacketHandler::queueSpace(Priority priority) const
+{
+    const auto queue = static_cast<std::size_t>(priority);
+    return txQueueLimits_[queue] > txQueuedBytes_[queue]
+               ? txQueueLimits_[queue] - txQueuedBytes_[queue]
+               : 0;
+}
+
+void PacketHandler::setMaxWindowSize(u8 size)
+{
+    maxWindowSize_ = std::max<u8>(1, std::min(size, MaxWindowSize));
+    windowSize_ = std::min(windowSize_, maxWindowSize_);
+}
+
+void PacketHandler::negotiateWindowSize()
+{
+    negotiationAttempts_ = NegotiationAttempts;
+    sendWindowSize(messages::Control::WindowSizeRequest, maxWindowSize_);
+}
+
+u8 PacketHandler::windowSize() const
+{
+    return windowSize_;
+}
+
+bool PacketHandler::creditLimited() const
+{
+    return peerCredited_;
+}
+
+std::size_t PacketHandler::credit() const
+{
+    if (!peerCredited_)
+    {
+        return std::numeric_limits<std::size_t>::max();
     }
-    u8 frameNumber = 0;
-    IFrame::FramePtr header(new Frame<6>());
-    header->port(port_);
-    header->number(frameNumber);
-    header->control(messages::Control::Transmission);
+    return peerCredit_ > txInFlightBytes_ ? peerCredit_ - txInFlightBytes_ : 0;
+}
 
-    u8 headerData[6];
-    serializer::serialize(static_cast<u8*>(headerData), static_cast<u16>(data.size()));
-    headerData[2] = 0;
-    headerData[3] = 0;
+u32 PacketHandler::creditStalls() const
+{
+    return creditStalls_;
+}
+
+void PacketHandler::setRetransmissionTimeoutLimits(u32 minimum, u32 maximum)
+{
+    rttEstimator_.setLimits(minimum, maximum);
+}
 
-    const auto crc = CRC::Calculate(static_cast<u8*>(headerData), 4, CRC::CRC_16_ARC());
-    serializer::serialize(&headerData[4], crc);
+u32 PacketHandler::rtt() const
+{
+    return rttEstimator_.srtt();
+}
 
-    header->payload(static_cast<u8*>(headerData), sizeof(headerData));
+u32 PacketHandler::rto() const
+{
+    return rttEstimator_.rto();
+}
 
-    txPacketBuffers_.emplace_back();
-    txPacketBuffers_.back().emplace_back(std::move(header));
+void PacketHandler::onFrame(const FrameView& frame)
+{
+    logger_.debug() << "Received frame " << std::to_string(frame.number());
+    switch (frame.control())
+    {
+        case messages::Control::Success:
+            onAck(frame);
+            break;
+        case messages::Control::CumulativeAck:
+            onCumulativeAck(frame);
+            break;
+        case messages::Control::CreditUpdate:
+            onCreditUpdate(frame);
+            break;
+        case messages::Control::Transmission:
+            onTransmission(frame);
+            break;
+        case messages::Control::PortNotConnect:
+        case messages::Control::CrcChecksumFailed:
+        case messages::Control::WrongEndByte:
+            onNack(frame);
+            break;
+        case messages::Control::WindowSizeRequest:
+            onWindowSizeRequest(frame);
+            break;
+        case messages::Control::WindowSizeResponse:
+            onWindowSizeResponse(frame);
+            break;
+        default:
+            break;
+    }
+}
 
-    for (auto size = 0; size < data.size(); size += MaxPayloadSize)
+void PacketHandler::onAck(const FrameView& frame)
+{
+    // credit is taken before confirmed frames stop counting against it
+    const bool credited = readCredit(frame.payload(), frame.length());
+    if (txInProgress_ && (frame.number() < txBase_ || frame.number() >= txNext_))
     {
-        IFrame::FramePtr frame(new Frame<>());
-        frame->port(port_);
-        frame->number(++frameNumber);
-        frame->control(messages::Control::Transmission);
-        u8 payloadSize = 0;
-        if (data.size() - size > MaxPayloadSize)
+        logger_.debug() << "Ack outside of window: " << std::to_string(frame.number());
+    }
+    else
+    {
+        acknowledge(frame.number(), 1);
+    }
+    if (credited)
+    {
+        transmit();
+    }
+}
+
+void PacketHandler::onCumulativeAck(const FrameView& frame)
+{
+    acknowledge(frame.number(), readBitmap(frame.payload(), frame.length()));
+}
+
+void PacketHandler::onCreditUpdate(const FrameView& frame)
+{
+    if (!readCredit(frame.payload(), frame.length()))
+    {
+        return;
+    }
+    const u64 bitmap = readBitmap(frame.payload() + sizeof(peerCredit_), // NOLINT
+                                  static_cast<u16>(frame.length() - sizeof(peerCredit_)));
+    if (bitmap != 0)
+    {
+        acknowledge(frame.number(), bitmap);
+    }
+    transmit();
+}
+
+bool PacketHandler::readCredit(const u8* data, const u16 length)
+{
+    if (length < sizeof(peerCredit_))
+    {
+        return false;
+    }
+    peerCredited_ = true;
+    serializer::deserialize(data, peerCredit_);
+    return true;
+}
+
+u64 PacketHandler::readBitmap(const u8* data, const u16 length)
+{
+    u64 bitmap = 0;
+    const u8 bytes = static_cast<u8>(std::min<u16>(length, sizeof(bitmap)));
+    for (u8 i = 0; i < bytes; ++i)
+    {
+        bitmap |= static_cast<u64>(data[i]) << i * 8; // NOLINT
+    }
+    return bitmap;
+}
+
+// Bit i of bitmap confirms frame first + i
+void PacketHandler::acknowledge(const std::size_t first, u64 bitmap)
+{
+    if (!txInProgress_)
+    {
+        return;
+    }
+
+    auto& frames = txPacket_.frames;
+    bool confirmed = false;
+    bool sampled = false;
+    u64 measuredFrom = 0;
+    // frames are numbered from 0 in each packet, so number is position in packet
+    for (std::size_t index = first; bitmap != 0; ++index, bitmap >>= 1)
+    {
+        if ((bitmap & 1) == 0 || index < txBase_ || index >= txNext_ || frames[index].confirmed)
         {
-            payloadSize = MaxPayloadSize;
+            continue;
         }
-        else
+
+        auto& confirmedFrame = frames[index];
+        confirmedFrame.confirmed = true;
+        timerManager_.cancel(confirmedFrame.timeout);
+        txInFlightBytes_ -= confirmedFrame.frame->length();
+        // confirmed frame is never sent again, streamed packets keep only window of frames
+        confirmedFrame.frame.reset();
+        confirmed = true;
+        // ack of retransmitted frame may belong to any of transmissions (Karn's rule). Round
+        // trip is measured from the same point as timeout is counted, frames queued in burst
+        // would inflate it. Cumulative ack gives one sample, from the newest frame it confirms.
+        if (confirmedFrame.transmissions == 1)
+        {
+            sampled = true;
+            measuredFrom = std::max({measuredFrom, confirmedFrame.sentAt, txLastAckAt_});
+        }
+    }
+    if (!confirmed)
+    {
+        return;
+    }
+
+    const u64 now = hal::time::now();
+    if (sampled)
+    {
+        // round trip below a millisecond still counts as one, estimator works in milliseconds
+        const u64 rtt = hal::time::roundUpToMilliseconds(now - measuredFrom);
+        rttEstimator_.sample(static_cast<u32>(rtt));
+    }
+    txLastAckAt_ = now;
+
+    while (txBase_ < frames.size() && frames[txBase_].confirmed)
+    {
+        ++txBase_;
+    }
+
+    if (txBase_ == txPacket_.frameCount)
+    {
+        finishPacket(true);
+        return;
+    }
+    transmit();
+}
+
+void PacketHandler::onNack(const FrameView& frame)
+{
+    if (!txInProgress_)
+    {
+        return;
+    }
+
+    const std::size_t index = frame.number();
+    if (index < txBase_ || index >= txNext_ || txPacket_.frames[index].confirmed)
+    {
+        return;
+    }
+
+    logger_.warn() << "Frame " << std::to_string(frame.number()) << " rejected with "
+                   << std::to_string(frame.control()) << ", retransmitting";
+    // receiver is alive and answered, so timeout doesn't back off
+    timerManager_.cancel(txPacket_.frames[index].timeout);
+    resend(index);
+}
+
+void PacketHandler::onTransmission(const FrameView& frame)
+{
+    assembler_.append(port_, frame.number(), BufferSpan{frame.payload(), frame.length()});
+    // sender doesn't open window until header is confirmed
+    if (frame.number() == 0)
+    {
+        handler_.flushAck(port_);
+    }
+}
+
+void PacketHandler::onWindowSizeRequest(const FrameView& frame)
+{
+    if (frame.length() != 1)
+    {
+        return;
+    }
+    windowSize_ = std::max<u8>(1, std::min(frame.payload()[0], maxWindowSize_));
+    logger_.info() << "Window size set to " << std::to_string(windowSize_);
+    sendWindowSize(messages::Control::WindowSizeResponse, windowSize_);
+}
+
+void PacketHandler::onWindowSizeResponse(const FrameView& frame)
+{
+    if (frame.length() != 1 || negotiationAttempts_ == 0)
+    {
+        return;
+    }
+    negotiationAttempts_ = 0;
+    timerManager_.cancel(negotiationTimeout_);
+    windowSize_ = std::max<u8>(1, std::min(frame.payload()[0], maxWindowSize_));
+    logger_.info() << "Window size negotiated to " << std::to_string(windowSize_);
+    transmit();
+}
+
+void PacketHandler::sendWindowSize(messages::Control control, u8 size)
+{
+    Frame<1> frame;
+    frame.port(port_);
+    frame.number(0);
+    frame.control(control);
+    frame.payload(&size, 1);
+    handler_.send(frame);
+
+    if (control != messages::Control::WindowSizeRequest)
+    {
+        return;
+    }
+    negotiationTimeout_ = timerManager_.arm(rttEstimator_.rto(), [this, size]() {
+        if (negotiationAttempts_ == 0 || --negotiationAttempts_ == 0)
         {
-            payloadSize = data.size() - size;
+            logger_.error() << "Window size negotiation failed";
+            return;
         }
-        logger_.debug() << "Created frame with size: " << static_cast<int>(payloadSize);
-        frame->payload(data.data() + size, payloadSize); // NOLINT
-        txPacketBuffers_.back().emplace_back(std::move(frame));
+        sendWindowSize(messages::Control::WindowSizeRequest, size);
+    });
+}
+
+void PacketHandler::transmit()
+{
+    if (!txInProgress_)
+    {
+        return;
     }
-    const u8 crcSize = 4;
 
-    IFrame::FramePtr crcFrame(new Frame<crcSize>());
-    crcFrame->port(port_);
-    crcFrame->number(++frameNumber);
-    crcFrame->control(messages::Control::Transmission);
-    u8 crcPayload[crcSize];
-    serializer::serialize(static_cast<u8*>(crcPayload),
-                          CRC::Calculate(data.data(), data.size(), CRC::CRC_32()));
+    if (!windowOpen())
+    {
+        return;
+    }
+    // streamed frame is produced before its turn, scheduler needs its size
+    if (txNext_ == txPacket_.frames.size() && !produceFrame())
+    {
+        dropPacket();
+        return;
+    }
+    if (txPacket_.frames[txNext_].frame->length() > credit())
+    {
+        waitForCredit();
+        return;
+    }
+
+    stopWaitingForCredit();
+    handler_.ready(port_);
+}
+
+void PacketHandler::waitForCredit()
+{
+    if (!creditStalled_)
+    {
+        creditStalled_ = true;
+        ++creditStalls_;
+        logger_.debug() << "Waiting for credit, " << std::to_string(peerCredit_)
+                        << " bytes granted";
+    }
+
+    // acks of frames in flight bring new credit, otherwise peer sends it when buffer is freed
+    timerManager_.cancel(creditTimeout_);
+    if (txInFlightBytes_ == 0)
+    {
+        creditTimeout_ = timerManager_.arm(rttEstimator_.rto(), [this]() { requestCredit(); });
+    }
+}
+
+void PacketHandler::stopWaitingForCredit()
+{
+    creditStalled_ = false;
+    timerManager_.cancel(creditTimeout_);
+}
+
+void PacketHandler::requestCredit()
+{
+    if (!creditStalled_)
+    {
+        return;
+    }
+    Frame<1> frame;
+    frame.port(port_);
+    frame.number(0);
+    frame.control(messages::Control::CreditRequest);
+    handler_.send(frame);
+    creditTimeout_ = timerManager_.arm(rttEstimator_.rto(), [this]() { requestCredit(); });
+}
 
-    crcFrame->payload(static_cast<u8*>(crcPayload), sizeof(crcPayload));
-    txPacketBuffers_.back().emplace_back(std::move(crcFrame));
+bool PacketHandler::windowOpen() const
+{
+    // until header is confirmed receiver doesn't know to which packet frames belong
+    const std::size_t window = txBase_ == 0 ? 1 : windowSize_;
+    return txNext_ < txPacket_.frameCount && txNext_ - txBase_ < window;
+}
 
-    txIndex_ = 0;
+std::size_t PacketHandler::nextFrameSize()
+{
+    if (!txInProgress_ || !windowOpen() || txNext_ == txPacket_.frames.size() ||
+        txPacket_.frames[txNext_].frame->length() > credit())
+    {
+        return 0;
+    }
+    return txPacket_.frames[txNext_].frame->length();
+}
+
+void PacketHandler::sendNextFrame()
+{
+    transmitFrame(txNext_++);
     transmit();
 }
 
-void PacketHandler::onFrame(const IFrame& frame)
+void PacketHandler::transmitFrame(std::size_t index)
 {
-    logger_.info() << "Received frame " << std::to_string(frame.number());
-    if (frame.control() == messages::Control::Success)
+    logger_.debug() << "Transmitting frame: " << std::to_string(index);
+    auto& frame = txPacket_.frames[index];
+    handler_.send(*frame.frame);
+    if (frame.transmissions == 0)
     {
-        auto& currentFrame = txPacketBuffers_.front().at(txIndex_);
-        logger_.info() << "It's ack frame for: " << currentFrame.frame->number();
+        txInFlightBytes_ += frame.frame->length();
+    }
+    ++frame.transmissions;
+    frame.sentAt = hal::time::now();
+    frame.timeout = timerManager_.arm(rttEstimator_.rto(), [this, index]() { retransmit(index); });
+}
 
-        // TODO: Test na to
-        if (currentFrame.frame->number() == frame.number())
+bool PacketHandler::overtaken(std::size_t index) const
+{
+    const auto& frames = txPacket_.frames;
+    for (std::size_t i = index + 1; i < txNext_; ++i)
+    {
+        if (frames[i].confirmed && frames[i].sentAt >= frames[index].sentAt)
         {
-            currentFrame.confirmed = true;
-            txTimeout_->cancel();
-            ++txIndex_;
-            transmit();
+            return true;
         }
     }
+    return false;
 }
 
-void PacketHandler::transmit()
+void PacketHandler::retransmit(std::size_t index)
 {
-    logger_.debug() << "Transmitting frame: " << std::to_string(txIndex_);
-    auto& frame = txPacketBuffers_.front().at(txIndex_);
+    if (!txInProgress_ || index >= txNext_ || txPacket_.frames[index].confirmed)
+    {
+        return;
+    }
+
+    // Frames sent in burst wait for the line behind each other. As in RFC 6298 timeout is
+    // restarted by every ack confirming new frame, so it's counted from the last progress.
+    // Link keeps order of frames, when later frame was confirmed this one is lost for sure.
+    auto& frame = txPacket_.frames[index];
+    const u64 now = hal::time::now();
+    const u64 deadline = std::max(frame.sentAt, txLastAckAt_) + u64(rttEstimator_.rto()) * 1000;
+    if (now < deadline && !overtaken(index))
+    {
+        const auto remaining = static_cast<u32>(hal::time::roundUpToMilliseconds(deadline - now));
+        frame.timeout = timerManager_.arm(remaining, [this, index]() { retransmit(index); });
+        return;
+    }
+
+    // all frames of window may time out together, back off once per window
+    if (index == txBase_)
+    {
+        rttEstimator_.backoff();
+    }
+    resend(index);
+}
 
-    if (!frame.confirmed)
+void PacketHandler::resend(std::size_t index)
+{
+    if (txPacket_.frames[index].transmissions > retryLimit_)
     {
-        handler_.send(*frame.frame);
-        txTimeout_ = timerManager_.setTimeout(400, std::bind(&PacketHandler::transmit, this));
+        logger_.error() << "Retry limit reached for frame " << std::to_string(index);
+        dropPacket();
+        return;
     }
+    transmitFrame(index);
 }
+
+void PacketHandler::dropPacket()
+{
+    for (auto& frame : txPacket_.frames)
+    {
+        timerManager_.cancel(frame.timeout);
+    }
+
+    logger_.error() << "Packet " << std::to_string(txPacket_.messageNumber) << " dropped";
+    if (failureHandler_)
+    {
+        failureHandler_(txPacket_.messageNumber);
+    }
+    finishPacket(false);
+}
+
+void PacketHandler::finishPacket(bool delivered)
+{
+    // callback may send next packet, so packet is released before it's called
+    TransmissionPacket packet = std::move(txPacket_);
+    txPacket_.frames.clear();
+    // frames go back to pool and list keeps its capacity for next packet
+    packet.frames.clear();
+    spareFrameLists_.push_back(std::move(packet.frames));
+    packet.payload.reset();
+    txQueuedBytes_[static_cast<std::size_t>(packet.priority)] -=
+        queuedBytes(packet.size, static_cast<bool>(packet.producer));
+    txInProgress_ = false;
+    txBase_ = 0;
+    txNext_ = 0;
+    txInFlightBytes_ = 0;
+    stopWaitingForCredit();
+
+    if (packet.completion)
+    {
+        packet.completion(delivered);
+    }
+    startPacket();
+}
+
+SendStatus PacketHandler::admit(std::size_t size, Priority priority, bool streamed)
+{
+    if (size > MaxPacketSize)
+    {
+        logger_.error() << "Packet size above max packet size";
+        return SendStatus::TooLarge;
+    }
+
+    if (queuedBytes(size, streamed) > queueSpace(priority))
+    {
+        logger_.debug() << "Queue full, "
+                        << std::to_string(txQueuedBytes_[static_cast<std::size_t>(priority)])
+                        << " bytes waiting";
+        return SendStatus::QueueFull;
+    }
+    return SendStatus::Queued;
+}
+
+TransmissionPacket& PacketHandler::enqueue(std::size_t size, Priority priority,
+                                           const CompletionCallback& completion,
+                                           const Producer& producer)
+{
+    smallFramePool_.reserve(1);
+
+    const auto queue = static_cast<std::size_t>(priority);
+    txQueues_[queue].emplace_back(txMessageNumber_, priority, size, completion);
+    auto& packet = txQueues_[queue].back();
+    packet.producer = producer;
+    // header, data frames and CRC frame
+    packet.frameCount = (size + MaxPayloadSize - 1) / MaxPayloadSize + 2;
+    txQueuedBytes_[queue] += queuedBytes(size, static_cast<bool>(producer));
+    if (!spareFrameLists_.empty())
+    {
+        packet.frames = std::move(spareFrameLists_.back());
+        spareFrameLists_.pop_back();
+    }
+    packet.frames.reserve(packet.frameCount);
+
+    u8 header[HeaderSize];
+    serializer::serialize(static_cast<u8*>(header), static_cast<u16>(size));
+    header[2] = txMessageNumber_++;
+    header[3] = 0;
+    const auto crc = crc::Crc16Arc::calculate(BufferSpan{static_cast<u8*>(header), 4});
+    serializer::serialize(&header[4], crc);
+
+    IFrame::FramePtr frame = smallFramePool_.allocate<Frame<HeaderSize>>();
+    frame->payload(static_cast<u8*>(header), sizeof(header));
+    appendFrame(packet, std::move(frame));
+    return packet;
+}
+
+void PacketHandler::appendFrame(TransmissionPacket& packet, IFrame::FramePtr frame)
+{
+    frame->port(port_);
+    frame->number(static_cast<u8>(packet.frames.size()));
+    frame->control(messages::Control::Transmission);
+    packet.frames.emplace_back(std::move(frame));
+}
+
+void PacketHandler::appendCrcFrame(TransmissionPacket& packet, u32 crc)
+{
+    u8 payload[Crc32Size];
+    serializer::serialize(static_cast<u8*>(payload), crc);
+    IFrame::FramePtr frame = smallFramePool_.allocate<Frame<Crc32Size>>();
+    frame->payload(static_cast<u8*>(payload), sizeof(payload));
+    appendFrame(packet, std::move(frame));
+}
+
+bool PacketHandler::produceFrame()
+{
+    auto& packet = txPacket_;
+    // frames before are header and data frames
+    const std::size_t offset = (packet.frames.size() - 1) * MaxPayloadSize;
+    if (offset >= packet.size)
+    {
+        appendCrcFrame(packet, packet.crc.value());
+        return true;
+    }
+
+    const auto length =
+        static_cast<u8>(std::min<std::size_t>(MaxPayloadSize, packet.size - offset));
+    u8 chunk[MaxPayloadSize];
+    if (!packet.producer(offset, static_cast<u8*>(chunk), length))
+    {
+        logger_.error() << "Producer failed at offset " << std::to_string(offset);
+        return false;
+    }
+    packet.crc.update(BufferSpan{static_cast<u8*>(chunk), length});
+
+    IFrame::FramePtr frame = framePool_.allocate();
+    frame->payload(static_cast<u8*>(chunk), length);
+    appendFrame(packet, std::move(frame));
+    return true;
+}
+
+std::size_t PacketHandler::queuedBytes(std::size_t size, bool streamed)
+{
+    // streamed payload doesn't wait in memory, but each packet holds producer, frame list and
+    // payload of frame being produced
+    return streamed ? MaxPayloadSize : size;
+}
+
+void PacketHandler::startPacket()
+{
+    if (txInProgress_)
+    {
+        return;
+    }
+
+    for (auto& queue : txQueues_)
+    {
+        if (!queue.empty())
+        {
+            txPacket_ = std::move(queue.front());
+            queue.erase(queue.begin());
+            txInProgress_ = true;
+            transmit();
+            return;
+        }
+    }
+}
+
 } // namespace protocol
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <array>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "logger/logger.hpp"
 #include "protocol/IFrame.hpp"
+#include "protocol/ITransmitSource.hpp"
+#include "protocol/crc.hpp"
 #include "protocol/frameHandler.hpp"
+#include "protocol/framePool.hpp"
+#include "protocol/limits.hpp"
+#include "protocol/packetAssembler.hpp"
+#include "protocol/rttEstimator.hpp"
 #include "timer/IManager.hpp"
 #include "utils/types.hpp"
 
@@ -13,42 +22,222 @@
 namespace protocol
 {
 
+const u8 MaxWindowSize = 64;
+const u8 DefaultRetryLimit = 8;
+
+// Priority is applied between packets, packet in flight is never interrupted
+enum class Priority : u8
+{
+    High = 0,
+    Normal = 1
+};
+
+const std::size_t PriorityLevels = 2;
+
+enum class SendStatus
+{
+    Queued,
+    QueueFull,
+    TooLarge
+};
+
 struct TransmissionFrame
 {
-    explicit TransmissionFrame(IFrame::FramePtr frame) : frame(std::move(frame)), confirmed(false)
+    explicit TransmissionFrame(IFrame::FramePtr frame)
+        : frame(std::move(frame)), confirmed(false), transmissions(0), sentAt(0)
     {
     }
 
     IFrame::FramePtr frame;
     bool confirmed;
+    u8 transmissions;
+    // hal::time::now() of last transmission, in microseconds
+    u64 sentAt;
+    timer::Handle timeout;
 };
 
-class PacketHandler
+struct TransmissionPacket
+{
+    using CompletionCallback = std::function<void(bool delivered)>;
+    // Fills length bytes of payload starting at offset, false aborts the packet
+    using Producer = std::function<bool(std::size_t offset, u8* data, u8 length)>;
+
+    TransmissionPacket() : messageNumber(0), priority(Priority::Normal), size(0), frameCount(0)
+    {
+    }
+
+    TransmissionPacket(u8 messageNumber, Priority priority, std::size_t size,
+                       const CompletionCallback& completion)
+        : messageNumber(messageNumber),
+          priority(priority),
+          size(size),
+          frameCount(0),
+          completion(completion)
+    {
+    }
+
+    u8 messageNumber;
+    Priority priority;
+    std::size_t size;
+    std::size_t frameCount;
+    // buffer viewed by slice frames, empty when payload was copied into frames
+    std::shared_ptr<const DataBuffer> payload;
+    // frames of streamed packet are produced when window reaches them
+    std::vector<TransmissionFrame> frames;
+    CompletionCallback completion;
+    Producer producer;
+    crc::Crc32 crc;
+};
+
+class PacketHandler : public ITransmitSource
 {
 public:
+    // Packet is valid only during the call, it points into reassembly buffer
+    using PacketReceiver = std::function<void(const BufferSpan& packet)>;
+    using CompletionCallback = TransmissionPacket::CompletionCallback;
+    using SharedBuffer = std::shared_ptr<const DataBuffer>;
+    using Producer = TransmissionPacket::Producer;
+    // Called with message number of dropped packet, packets are numbered from 0 in order of send
+    using FailureHandler = std::function<void(u8 messageNumber)>;
+
+    // Handler owns the link alone
     PacketHandler(u16 port, const dispatcher::IDataReceiver::RawDataReceiverPtr& receiver,
                   timer::IManager& timerManager);
-    ~PacketHandler() = default;
+    // Handler shares link with other ports of frame handler, which has to outlive it
+    PacketHandler(u16 port, FrameHandler& handler, timer::IManager& timerManager);
+    ~PacketHandler() override;
     PacketHandler(const PacketHandler&) = delete;
     PacketHandler(const PacketHandler&&) = delete;
     PacketHandler& operator=(const PacketHandler&&) = delete;
     PacketHandler& operator=(const PacketHandler&) = delete;
-    void send(const DataBuffer& data);
+    // Completion is called with true when whole packet is confirmed, false when it was dropped.
+    // QueueFull means caller has to retry after some of queued packets are completed.
+    SendStatus send(const DataBuffer& data, Priority priority = Priority::Normal,
+                    const CompletionCallback& completion = CompletionCallback{});
+    // Frames are views into the buffer, which is held until packet is completed
+    SendStatus send(DataBuffer&& data, Priority priority = Priority::Normal,
+                    const CompletionCallback& completion = CompletionCallback{});
+    SendStatus send(const SharedBuffer& data, Priority priority = Priority::Normal,
+                    const CompletionCallback& completion = CompletionCallback{});
+    // Payload is pulled from producer frame by frame as window advances, so only frames in
+    // flight are kept in memory. Streamed packet takes one frame of payload from queue space.
+    SendStatus send(std::size_t size, const Producer& producer,
+                    Priority priority = Priority::Normal,
+                    const CompletionCallback& completion = CompletionCallback{});
+    void setPacketReceiver(const PacketReceiver& receiver);
+    // Share of shared link this port gets while other ports send too, see FrameHandler
+    void setTransmitWeight(u8 weight);
+    void setFailureHandler(const FailureHandler& handler);
+
+    // Packet is dropped when any of its frames isn't confirmed after this many retransmissions
+    void setRetryLimit(u8 retries);
+
+    // Bytes of payload which may wait in queue of given priority, including packet in flight
+    void setQueueLimit(Priority priority, std::size_t bytes);
+    std::size_t queueSpace(Priority priority) const;
+
+    // Local limit of frames in flight, peers use minimum of both limits after negotiation
+    void setMaxWindowSize(u8 size);
+    void negotiateWindowSize();
+    u8 windowSize() const;
+
+    // Received frames are confirmed together, see FrameHandler::setDelayedAck. Header and last
+    // frame of packet are confirmed at once, sender waits for them. Applies to all ports of
+    // shared frame handler.
+    void setDelayedAck(u8 frames, u32 milliseconds);
+
+    // Peer which advertises credit, see FrameHandler::setReceiveCredit, gets new frames only while
+    // their payload fits into the credit minus payload of unconfirmed frames. Stalled sender asks
+    // for credit every retransmission timeout, in case update from peer was lost.
+    bool creditLimited() const;
+    // Bytes of payload which may be sent now, SIZE_MAX when peer doesn't limit them
+    std::size_t credit() const;
+    u32 creditStalls() const;
+
+    void setRetransmissionTimeoutLimits(u32 minimum, u32 maximum);
+    // Smoothed round trip time and current retransmission timeout in milliseconds, round trip is
+    // measured from sending of frame or from the previous ack when frame was queued behind others
+    u32 rtt() const;
+    u32 rto() const;
+
+    std::size_t nextFrameSize() override;
+    void sendNextFrame() override;
 
 protected:
-    void onFrame(const IFrame& frame);
+    PacketHandler(u16 port, std::unique_ptr<FrameHandler> ownedHandler, FrameHandler* handler,
+                  timer::IManager& timerManager);
+
+    void onFrame(const FrameView& frame);
+    void onAck(const FrameView& frame);
+    void onCumulativeAck(const FrameView& frame);
+    void onCreditUpdate(const FrameView& frame);
+    bool readCredit(const u8* data, u16 length);
+    static u64 readBitmap(const u8* data, u16 length);
+    void waitForCredit();
+    void stopWaitingForCredit();
+    void requestCredit();
+    void acknowledge(std::size_t first, u64 bitmap);
+    void onNack(const FrameView& frame);
+    void onTransmission(const FrameView& frame);
+    void onWindowSizeRequest(const FrameView& frame);
+    void onWindowSizeResponse(const FrameView& frame);
+    void sendWindowSize(messages::Control control, u8 size);
+    SendStatus admit(std::size_t size, Priority priority, bool streamed);
+    TransmissionPacket& enqueue(std::size_t size, Priority priority,
+                                const CompletionCallback& completion,
+                                const Producer& producer = Producer{});
+    bool produceFrame();
+    static std::size_t queuedBytes(std::size_t size, bool streamed);
+    void appendFrame(TransmissionPacket& packet, IFrame::FramePtr frame);
+    void appendCrcFrame(TransmissionPacket& packet, u32 crc);
     void transmit();
-    FrameHandler handler_;
-    std::vector<std::pair<DataBuffer, bool>> rxPacketBuffers_;
-    std::vector<std::vector<TransmissionFrame>> txPacketBuffers_;
-    u8 txIndex_;
+    bool windowOpen() const;
+    void transmitFrame(std::size_t index);
+    void retransmit(std::size_t index);
+    void resend(std::size_t index);
+    void dropPacket();
+    void finishPacket(bool delivered);
+    void startPacket();
+    bool overtaken(std::size_t index) const;
+
+    // set when handler isn't shared
+    std::unique_ptr<FrameHandler> ownedHandler_;
+    FrameHandler& handler_;
+    PacketAssembler assembler_;
+    // frames are released into pools, so they are destroyed after packets
+    FramePool framePool_;
+    // header, CRC and slice frames
+    FramePool smallFramePool_;
+    // queues and frame lists keep their capacity, steady state sending doesn't allocate
+    std::array<std::vector<TransmissionPacket>, PriorityLevels> txQueues_;
+    std::vector<std::vector<TransmissionFrame>> spareFrameLists_;
+    std::array<std::size_t, PriorityLevels> txQueuedBytes_;
+    std::array<std::size_t, PriorityLevels> txQueueLimits_;
+    TransmissionPacket txPacket_;
+    bool txInProgress_;
+    std::size_t txBase_;
+    std::size_t txNext_;
+    u64 txLastAckAt_;
+    // payload of sent frames which aren't confirmed yet
+    std::size_t txInFlightBytes_;
+    bool peerCredited_;
+    u16 peerCredit_;
+    bool creditStalled_;
+    u32 creditStalls_;
+    u8 windowSize_;
+    u8 maxWindowSize_;
+    u8 negotiationAttempts_;
+    u8 retryLimit_;
+    RttEstimator rttEstimator_;
 
     u16 port_;
-    u8 rxMessageNumber_;
     u8 txMessageNumber_;
     logger::Logger logger_;
     timer::IManager& timerManager_;
-    timer::ITimer::TimerPtr txTimeout_;
+    timer::Handle negotiationTimeout_;
+    timer::Handle creditTimeout_;
+    FailureHandler failureHandler_;
+    PacketReceiver packetReceiver_;
 };
 
 } // namespace protocol
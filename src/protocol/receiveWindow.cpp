@@ -0,0 +1,67 @@
+#include "protocol/receiveWindow.hpp"
+
+#include <algorithm>
+
+namespace protocol
+{
+
+const u8 ReceiveWindow::MaxSize;
+
+ReceiveWindow::ReceiveWindow(u8 size) : size_(0), next_(0), synchronised_(false)
+{
+    resize(size);
+}
+
+void ReceiveWindow::resize(u8 size)
+{
+    size_ = std::min(size, MaxSize);
+    restart();
+}
+
+u8 ReceiveWindow::size() const
+{
+    return size_;
+}
+
+void ReceiveWindow::restart()
+{
+    received_.reset();
+    synchronised_ = false;
+}
+
+bool ReceiveWindow::accept(u8 number)
+{
+    if (size_ == 0)
+    {
+        return true;
+    }
+
+    // distance from next expected frame, wraps around together with numbers
+    u8 offset = static_cast<u8>(number - next_);
+    if (synchronised_ && offset >= 256 - size_)
+    {
+        return false;
+    }
+
+    if (!synchronised_ || offset >= size_)
+    {
+        synchronised_ = true;
+        received_.reset();
+        next_ = number;
+        offset = 0;
+    }
+    else if (received_[offset])
+    {
+        return false;
+    }
+
+    received_[offset] = true;
+    while (received_[0])
+    {
+        received_ >>= 1;
+        ++next_;
+    }
+    return true;
+}
+
+} // namespace protocol
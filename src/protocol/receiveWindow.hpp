@@ -0,0 +1,39 @@
+#pragma once
+
+#include <bitset>
+
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+/* Tracks frame numbers received on port to find retransmissions of frames which were already
+ * delivered. Numbers are compared modulo 256, size numbers behind and ahead of next expected
+ * one are known. Frame far outside of both ranges means peer restarted numbering.
+ */
+class ReceiveWindow
+{
+public:
+    // ranges behind and ahead of window can't overlap in 8 bit numbers
+    static const u8 MaxSize = 128;
+
+    explicit ReceiveWindow(u8 size = 0);
+
+    // Size 0 disables the window, every frame is accepted
+    void resize(u8 size);
+    u8 size() const;
+
+    // Forgets received numbers, next frame starts new numbering
+    void restart();
+
+    // Returns false when frame was received before
+    bool accept(u8 number);
+
+private:
+    std::bitset<MaxSize> received_;
+    u8 size_;
+    u8 next_;
+    bool synchronised_;
+};
+
+} // namespace protocol
@@ -0,0 +1,81 @@
+#include "protocol/rttEstimator.hpp"
+
+#include <algorithm>
+
+namespace protocol
+{
+
+namespace
+{
+// SRTT is stored multiplied by 8 and RTTVAR by 4, so gains 1/8 and 1/4 are shifts
+const u8 SrttShift = 3;
+const u8 RttvarShift = 2;
+// samples are whole milliseconds
+const u32 Granularity = 1;
+} // namespace
+
+const u32 RttEstimator::InitialRto;
+const u32 RttEstimator::DefaultMinimumRto;
+const u32 RttEstimator::DefaultMaximumRto;
+
+RttEstimator::RttEstimator(u32 minimumRto, u32 maximumRto)
+    : measured_(false), scaledSrtt_(0), scaledRttvar_(0), rto_(0), minimumRto_(minimumRto),
+      maximumRto_(maximumRto)
+{
+    rto_ = clamp(InitialRto);
+}
+
+void RttEstimator::setLimits(u32 minimumRto, u32 maximumRto)
+{
+    minimumRto_ = minimumRto;
+    maximumRto_ = std::max(minimumRto, maximumRto);
+    rto_ = clamp(rto_);
+}
+
+void RttEstimator::sample(u32 rtt)
+{
+    if (!measured_)
+    {
+        measured_ = true;
+        scaledSrtt_ = rtt << SrttShift;
+        scaledRttvar_ = (rtt / 2) << RttvarShift;
+    }
+    else
+    {
+        const u32 srtt = scaledSrtt_ >> SrttShift;
+        const u32 delta = srtt > rtt ? srtt - rtt : rtt - srtt;
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+        scaledRttvar_ = scaledRttvar_ - (scaledRttvar_ >> RttvarShift) + delta;
+        scaledSrtt_ = scaledSrtt_ - (scaledSrtt_ >> SrttShift) + rtt;
+    }
+
+    // scaled RTTVAR equals K * RTTVAR with K = 4
+    rto_ = clamp(srtt() + std::max(Granularity, scaledRttvar_));
+}
+
+void RttEstimator::backoff()
+{
+    rto_ = clamp(rto_ > maximumRto_ / 2 ? maximumRto_ : rto_ * 2);
+}
+
+u32 RttEstimator::srtt() const
+{
+    return scaledSrtt_ >> SrttShift;
+}
+
+u32 RttEstimator::rttvar() const
+{
+    return scaledRttvar_ >> RttvarShift;
+}
+
+u32 RttEstimator::rto() const
+{
+    return rto_;
+}
+
+u32 RttEstimator::clamp(u32 rto) const
+{
+    return std::min(maximumRto_, std::max(minimumRto_, rto));
+}
+
+} // namespace protocol
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+/* Retransmission timeout estimation as described by Jacobson/Karels (RFC 6298).
+ * Values are kept in milliseconds, smoothed values are scaled to keep precision in integers.
+ */
+class RttEstimator
+{
+public:
+    static const u32 InitialRto = 400;
+    static const u32 DefaultMinimumRto = 20;
+    static const u32 DefaultMaximumRto = 8000;
+
+    RttEstimator(u32 minimumRto = DefaultMinimumRto, u32 maximumRto = DefaultMaximumRto);
+
+    void setLimits(u32 minimumRto, u32 maximumRto);
+    // Only round trips of frames sent once may be sampled (Karn's rule)
+    void sample(u32 rtt);
+    void backoff();
+
+    u32 srtt() const;
+    u32 rttvar() const;
+    u32 rto() const;
+
+private:
+    u32 clamp(u32 rto) const;
+
+    bool measured_;
+    u32 scaledSrtt_;
+    u32 scaledRttvar_;
+    u32 rto_;
+    u32 minimumRto_;
+    u32 maximumRto_;
+};
+
+} // namespace protocol
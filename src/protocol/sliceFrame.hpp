@@ -0,0 +1,96 @@
+#pragma once
+
+#include "protocol/IFrame.hpp"
+#include "protocol/crc.hpp"
+#include "utils/types.hpp"
+
+namespace protocol
+{
+
+// Frame which payload is a view into packet buffer, buffer must outlive the frame
+class SliceFrame : public IFrame
+{
+public:
+    SliceFrame(const u8* data, u16 length)
+        : port_{0},
+          number_{0},
+          control_{0},
+          length_(length),
+          data_(data),
+          crc_(crc::Crc16Arc::calculate(BufferSpan{data, length}))
+    {
+    }
+
+    void port(u8 port) override
+    {
+        port_ = port;
+    }
+
+    u8 port() const override
+    {
+        return port_;
+    }
+
+    void number(u8 number) override
+    {
+        number_ = number;
+    }
+
+    u8 number() const override
+    {
+        return number_;
+    }
+
+    void control(u8 control) override
+    {
+        control_ = control;
+    }
+
+    u8 control() const override
+    {
+        return control_;
+    }
+
+    void clear() override
+    {
+        port_ = 0;
+        number_ = 0;
+        control_ = 0;
+    }
+
+    // payload is fixed by the view
+    u16 payload(const u8* /*data*/, u16 /*length*/) override
+    {
+        return 0;
+    }
+
+    const u8* payload() const override
+    {
+        return data_;
+    }
+
+    u16 length() const override
+    {
+        return length_;
+    }
+
+    u16 crc() const override
+    {
+        return crc_;
+    }
+
+    u16 payloadSize() const override
+    {
+        return length_;
+    }
+
+private:
+    u8 port_;
+    u8 number_;
+    u8 control_;
+    u16 length_;
+    const u8* data_;
+    u16 crc_;
+};
+
+} // namespace protocol
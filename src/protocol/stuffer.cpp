@@ -0,0 +1,81 @@
+#include "protocol/stuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace protocol
+{
+
+namespace
+{
+// code byte holds distance to next zero, longest block without zero is one less
+const u8 MaxCode = 0xff;
+const std::size_t MaxBlock = MaxCode - 1;
+} // namespace
+
+std::size_t stuff(const BufferSpan& input, const gsl::span<u8>& output)
+{
+    if (static_cast<std::size_t>(output.size()) < maxStuffedSize(input.size()))
+    {
+        return 0;
+    }
+
+    const u8* in = input.data();
+    const u8* const end = in + input.size(); // NOLINT
+    u8* out = output.data();
+    while (true)
+    {
+        const std::size_t block = std::min<std::size_t>(end - in, MaxBlock);
+        const auto* zero = static_cast<const u8*>(std::memchr(in, Delimiter, block));
+        const std::size_t run = zero != nullptr ? zero - in : block;
+
+        *out++ = static_cast<u8>(run + 1); // NOLINT
+        std::memcpy(out, in, run);
+        out += run; // NOLINT
+        in += run;  // NOLINT
+        if (zero != nullptr)
+        {
+            // zero is encoded by code byte, zero at the end leaves empty block after it
+            ++in; // NOLINT
+        }
+        else if (in == end)
+        {
+            break;
+        }
+    }
+    return out - output.data();
+}
+
+std::size_t unstuff(const BufferSpan& input, const gsl::span<u8>& output)
+{
+    const u8* in = input.data();
+    const u8* const end = in + input.size(); // NOLINT
+    u8* out = output.data();
+    u8* const outEnd = out + output.size(); // NOLINT
+    while (in != end)
+    {
+        const u8 code = *in++; // NOLINT
+        const std::size_t run = code - 1u;
+        if (code == Delimiter || run > static_cast<std::size_t>(end - in) ||
+            run > static_cast<std::size_t>(outEnd - out))
+        {
+            return 0;
+        }
+
+        std::memcpy(out, in, run);
+        out += run; // NOLINT
+        in += run;  // NOLINT
+        // full block isn't followed by zero, last block ends data
+        if (code != MaxCode && in != end)
+        {
+            if (out == outEnd)
+            {
+                return 0;
+            }
+            *out++ = 0; // NOLINT
+        }
+    }
+    return out - output.data();
+}
+
+} // namespace protocol
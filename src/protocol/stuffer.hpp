@@ -1,8 +1,25 @@
 #pragma once
 
+#include <gsl/span>
+
+#include "utils/types.hpp"
+
 namespace protocol
 {
 
-void StuffByte();
+/* Consistent Overhead Byte Stuffing. Stuffed data contains no Delimiter, so receiver finds
+ * start of next frame on first delimiter after damaged one. Costs one byte per 254 bytes.
+ */
+const u8 Delimiter = 0x00;
+
+constexpr std::size_t maxStuffedSize(const std::size_t size)
+{
+    return size + size / 254 + 1;
+}
+
+// Delimiter isn't appended. Returns 0 when output is smaller than maxStuffedSize(input).
+std::size_t stuff(const BufferSpan& input, const gsl::span<u8>& output);
+// Returns size of original data, 0 when input is malformed or doesn't fit into output
+std::size_t unstuff(const BufferSpan& input, const gsl::span<u8>& output);
 
 } // namespace protocol
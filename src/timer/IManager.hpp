@@ -1,12 +1,17 @@
 #pragma once
 
 #include "timer/ITimer.hpp"
+#include "timer/callback.hpp"
+#include "timer/handle.hpp"
 
 #include "utils/types.hpp"
 
 namespace timer
 {
 
+// No timer is set, run() has nothing to do until one is
+const u32 NoDeadline = 0xffffffff;
+
 class IManager
 {
 public:
@@ -15,7 +20,16 @@ public:
     virtual ITimer::TimerPtr setInterval(u32 milliseconds, ITimer::TimerCallback callback,
                                          int times) = 0;
 
+    // Timeout which doesn't allocate when the manager supports it, handle doesn't own the timer
+    virtual Handle arm(u32 milliseconds, Callback callback) = 0;
+    // Stops the timer if it didn't fire yet and clears the handle
+    virtual void cancel(Handle& handle) = 0;
+    virtual bool armed(Handle handle) const = 0;
+
     virtual void run() = 0;
+    // Milliseconds after which run() has work to do, 0 when a timer is due already.
+    // It is never later than the nearest timer, so caller may sleep for that long.
+    virtual u32 timeToNextDeadline() const = 0;
 };
 
 } // namespace timer
@@ -3,6 +3,8 @@
 #include <functional>
 #include <memory>
 
+#include "utils/types.hpp"
+
 namespace timer
 {
 
@@ -22,6 +24,8 @@ public:
     virtual void run() = 0;
     virtual void cancel() = 0;
     virtual bool enabled() const = 0;
+    // hal::time::now() at which timer fires next, in microseconds
+    virtual u64 deadline() const = 0;
 
 protected:
     virtual void fire() = 0;
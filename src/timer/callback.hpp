@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace timer
+{
+
+/* Function called by timer, kept inside of the timer instead of on the heap. Lambda capturing
+ * a few pointers or indexes fits, larger one is rejected at compile time.
+ */
+class Callback
+{
+public:
+    static const std::size_t Capacity = 4 * sizeof(void*);
+
+    Callback() : operations_(nullptr)
+    {
+    }
+
+    template <typename Function,
+              typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<Function>::type, Callback>::value>::type>
+    Callback(Function&& function) // NOLINT(google-explicit-constructor)
+        : operations_(&Operations<typename std::decay<Function>::type>::table)
+    {
+        using Stored = typename std::decay<Function>::type;
+        static_assert(sizeof(Stored) <= Capacity, "Callback captures too much");
+        static_assert(alignof(Stored) <= alignof(Storage), "Callback alignment above storage");
+        new (&storage_) Stored(std::forward<Function>(function));
+    }
+
+    ~Callback()
+    {
+        reset();
+    }
+
+    Callback(Callback&& other) noexcept : operations_(other.operations_)
+    {
+        if (nullptr != operations_)
+        {
+            operations_->move(&storage_, &other.storage_);
+            other.operations_ = nullptr;
+        }
+    }
+
+    Callback& operator=(Callback&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            operations_ = other.operations_;
+            if (nullptr != operations_)
+            {
+                operations_->move(&storage_, &other.storage_);
+                other.operations_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Callback(const Callback&) = delete;
+    Callback& operator=(const Callback&) = delete;
+
+    void operator()()
+    {
+        operations_->invoke(&storage_);
+    }
+
+    explicit operator bool() const
+    {
+        return nullptr != operations_;
+    }
+
+    void reset()
+    {
+        if (nullptr != operations_)
+        {
+            const Table* operations = operations_;
+            operations_ = nullptr;
+            operations->destroy(&storage_);
+        }
+    }
+
+private:
+    using Storage = std::aligned_storage<Capacity, alignof(std::max_align_t)>::type;
+
+    struct Table
+    {
+        void (*invoke)(void* function);
+        // move constructs into destination and destroys source
+        void (*move)(void* destination, void* source);
+        void (*destroy)(void* function);
+    };
+
+    template <typename Function>
+    struct Operations
+    {
+        static void invoke(void* function)
+        {
+            (*static_cast<Function*>(function))();
+        }
+
+        static void move(void* destination, void* source)
+        {
+            new (destination) Function(std::move(*static_cast<Function*>(source)));
+            static_cast<Function*>(source)->~Function();
+        }
+
+        static void destroy(void* function)
+        {
+            static_cast<Function*>(function)->~Function();
+        }
+
+        static const Table table;
+    };
+
+    Storage storage_;
+    const Table* operations_;
+};
+
+template <typename Function>
+const Callback::Table Callback::Operations<Function>::table = {
+    &Callback::Operations<Function>::invoke, &Callback::Operations<Function>::move,
+    &Callback::Operations<Function>::destroy};
+
+} // namespace timer
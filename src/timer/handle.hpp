@@ -0,0 +1,18 @@
+#pragma once
+
+#include "utils/types.hpp"
+
+namespace timer
+{
+
+/* Refers to timer armed with IManager::arm. Slot of expired or cancelled timer is reused, its
+ * generation changes then, so stale handle never cancels somebody else's timer.
+ * Default handle refers to no timer.
+ */
+struct Handle
+{
+    u32 index = 0;
+    u32 generation = 0;
+};
+
+} // namespace timer
@@ -0,0 +1,85 @@
+#include "timer/inbox.hpp"
+
+#include <utility>
+
+namespace timer
+{
+
+const std::size_t Inbox::DefaultCapacity = 64;
+
+Inbox::Inbox(IManager& manager, const std::size_t capacity, const WakeUp wakeUp)
+    : manager_(manager), queue_(capacity), wakeUp_(wakeUp), signalled_(false)
+{
+}
+
+bool Inbox::post(Callback closure)
+{
+    return push(Kind::Post, std::move(closure), nullptr, 0);
+}
+
+bool Inbox::arm(const u32 milliseconds, Callback callback, Handle* handle)
+{
+    return push(Kind::Arm, std::move(callback), handle, milliseconds);
+}
+
+bool Inbox::cancel(Handle& handle)
+{
+    return push(Kind::Cancel, Callback(), &handle, 0);
+}
+
+std::size_t Inbox::drain()
+{
+    // posts from now on wake owner again, they are either drained below or in next call
+    signalled_.exchange(false, std::memory_order_acq_rel);
+
+    // messages posted by the drained closures wait for next call
+    std::size_t drained = 0;
+    Message message;
+    for (std::size_t pending = queue_.size(); pending > 0 && queue_.pop(message); --pending)
+    {
+        switch (message.kind)
+        {
+            case Kind::Post:
+                message.callback();
+                break;
+            case Kind::Arm:
+            {
+                const Handle handle = manager_.arm(message.milliseconds,
+                                                   std::move(message.callback));
+                if (nullptr != message.handle)
+                {
+                    *message.handle = handle;
+                }
+                break;
+            }
+            case Kind::Cancel:
+                manager_.cancel(*message.handle);
+                break;
+        }
+        // captures are released on owning thread
+        message.callback.reset();
+        ++drained;
+    }
+    return drained;
+}
+
+bool Inbox::push(const Kind kind, Callback callback, Handle* handle, const u32 milliseconds)
+{
+    Message message;
+    message.callback = std::move(callback);
+    message.handle = handle;
+    message.milliseconds = milliseconds;
+    message.kind = kind;
+    if (!queue_.push(std::move(message)))
+    {
+        return false;
+    }
+
+    if (!signalled_.exchange(true, std::memory_order_acq_rel) && nullptr != wakeUp_)
+    {
+        wakeUp_();
+    }
+    return true;
+}
+
+} // namespace timer
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "container/mpscQueue.hpp"
+#include "timer/IManager.hpp"
+#include "timer/callback.hpp"
+#include "timer/handle.hpp"
+
+#include <atomic>
+
+#include "utils/types.hpp"
+
+namespace timer
+{
+
+/* Way for other threads to reach the thread which owns the timer manager. Any thread may post
+ * a closure or ask for a timer to be armed or cancelled without taking a lock, the owner runs
+ * them in batches in drain(). Owner is woken only by the first post after it drained the inbox.
+ */
+class Inbox
+{
+public:
+    using WakeUp = void (*)();
+
+    static const std::size_t DefaultCapacity;
+
+    explicit Inbox(IManager& manager, std::size_t capacity = DefaultCapacity,
+                   WakeUp wakeUp = nullptr);
+    ~Inbox() = default;
+    Inbox(const Inbox&) = delete;
+    Inbox(const Inbox&&) = delete;
+    Inbox& operator=(const Inbox&&) = delete;
+    Inbox& operator=(const Inbox&) = delete;
+
+    // Any thread, false when inbox is full and nothing was posted.
+    // Handle given to arm and cancel is written and read only by the owning thread.
+    bool post(Callback closure);
+    bool arm(u32 milliseconds, Callback callback, Handle* handle = nullptr);
+    bool cancel(Handle& handle);
+
+    // Owning thread, runs what was posted before the call and returns how many
+    std::size_t drain();
+
+private:
+    enum class Kind : u8
+    {
+        Post,
+        Arm,
+        Cancel
+    };
+
+    struct Message
+    {
+        Callback callback;
+        Handle* handle = nullptr;
+        u32 milliseconds = 0;
+        Kind kind = Kind::Post;
+    };
+
+    bool push(Kind kind, Callback callback, Handle* handle, u32 milliseconds);
+
+    IManager& manager_;
+    container::MpscQueue<Message> queue_;
+    WakeUp wakeUp_;
+    // set by first post after drain, so rest of the batch doesn't wake owner again
+    std::atomic<bool> signalled_;
+};
+
+} // namespace timer
@@ -10,14 +10,14 @@ namespace timer
 {
 
 IntervalTimer::IntervalTimer(const u64 time, TimerCallback callback, const int times)
-    : callback_(std::move(callback)), startTime_(hal::time::milliseconds()), time_(time),
+    : callback_(std::move(callback)), startTime_(hal::time::now()), time_(time),
       enabled_(true), times_(times)
 {
 }
 
 void IntervalTimer::run()
 {
-    if (hal::time::milliseconds() - startTime_ >= time_)
+    if (hal::time::now() - startTime_ >= time_ * 1000)
     {
         fire();
     }
@@ -33,12 +33,17 @@ bool IntervalTimer::enabled() const
     return enabled_;
 }
 
+u64 IntervalTimer::deadline() const
+{
+    return startTime_ + time_ * 1000;
+}
+
 
 void IntervalTimer::fire()
 {
     if (enabled_)
     {
-        startTime_ = hal::time::milliseconds();
+        startTime_ = hal::time::now();
 
         if (-1 != times_)
         {
@@ -14,6 +14,7 @@ public:
     void run() override;
     void cancel() override;
     bool enabled() const override;
+    u64 deadline() const override;
 
 protected:
     void fire() override;
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 
+#include "hal/time/time.hpp"
 #include "timer/intervalTimer.hpp"
 #include "timer/timeoutTimer.hpp"
 
@@ -26,11 +27,71 @@ ITimer::TimerPtr Manager::setInterval(u32 milliseconds, ITimer::TimerCallback ca
     return timers_.back();
 }
 
+Handle Manager::arm(u32 milliseconds, Callback callback)
+{
+    if (freeHandles_.empty())
+    {
+        freeHandles_.push_back(static_cast<u32>(handles_.size()));
+        handles_.push_back(HandleSlot{nullptr, 1});
+    }
+    const u32 index = freeHandles_.back();
+    freeHandles_.pop_back();
+
+    const Handle handle{index, handles_[index].generation};
+    // std::function needs copyable target, the callback is shared instead
+    auto shared = std::make_shared<Callback>(std::move(callback));
+    handles_[index].timer = setTimeout(milliseconds, [this, handle, shared]() {
+        release(handle);
+        (*shared)();
+    });
+    return handle;
+}
+
+void Manager::cancel(Handle& handle)
+{
+    if (nullptr != find(handle))
+    {
+        handles_[handle.index].timer->cancel();
+        release(handle);
+    }
+    handle = Handle{};
+}
+
+bool Manager::armed(const Handle handle) const
+{
+    const HandleSlot* slot = find(handle);
+    return nullptr != slot && slot->timer->enabled();
+}
+
+const Manager::HandleSlot* Manager::find(const Handle handle) const
+{
+    if (handle.index >= handles_.size() || handles_[handle.index].generation != handle.generation ||
+        !handles_[handle.index].timer)
+    {
+        return nullptr;
+    }
+    return &handles_[handle.index];
+}
+
+void Manager::release(const Handle handle)
+{
+    HandleSlot& slot = handles_[handle.index];
+    slot.timer.reset();
+    // generation 0 is left for empty handle
+    if (0 == ++slot.generation)
+    {
+        slot.generation = 1;
+    }
+    freeHandles_.push_back(handle.index);
+}
+
 void Manager::run()
 {
-    for (auto& timer : timers_)
+    // callbacks may register new timers, which invalidates iterators
+    const std::size_t timersToRun = timers_.size();
+    for (std::size_t i = 0; i < timersToRun; ++i)
     {
-        timer->run();
+        timers_[i]->run();
     }
 
     timers_.erase(std::remove_if(timers_.begin(), timers_.end(),
@@ -38,4 +99,22 @@ void Manager::run()
                   timers_.end());
 }
 
+u32 Manager::timeToNextDeadline() const
+{
+    // time spent since the loop ticked counts too, so the clock is read again
+    const u64 now = hal::time::microseconds();
+    u64 next = NoDeadline;
+    for (const auto& timer : timers_)
+    {
+        if (timer->enabled())
+        {
+            const u64 deadline = timer->deadline();
+            next = std::min(next, deadline > now
+                                      ? hal::time::roundUpToMilliseconds(deadline - now)
+                                      : 0);
+        }
+    }
+    return static_cast<u32>(next);
+}
+
 } // namespace timer
@@ -16,11 +16,28 @@ public:
     ITimer::TimerPtr setInterval(u32 milliseconds, ITimer::TimerCallback callback,
                                  int times) override;
 
+    Handle arm(u32 milliseconds, Callback callback) override;
+    void cancel(Handle& handle) override;
+    bool armed(Handle handle) const override;
+
     void run() override;
+    u32 timeToNextDeadline() const override;
 
 private:
+    // handle refers to timer through this table, timers themselves are allocated as before
+    struct HandleSlot
+    {
+        ITimer::TimerPtr timer;
+        u32 generation;
+    };
+
+    const HandleSlot* find(Handle handle) const;
+    void release(Handle handle);
+
     using TimerContainer = std::vector<ITimer::TimerPtr>;
     TimerContainer timers_;
+    std::vector<HandleSlot> handles_;
+    std::vector<u32> freeHandles_;
 };
 
 } // namespace timer
@@ -7,14 +7,14 @@ namespace timer
 {
 
 TimeoutTimer::TimeoutTimer(const u64 time, TimerCallback callback)
-    : callback_(std::move(callback)), startTime_(hal::time::milliseconds()), time_(time),
+    : callback_(std::move(callback)), startTime_(hal::time::now()), time_(time),
       enabled_(true)
 {
 }
 
 void TimeoutTimer::run()
 {
-    if (hal::time::milliseconds() - startTime_ >= time_)
+    if (hal::time::now() - startTime_ >= time_ * 1000)
     {
         fire();
     }
@@ -30,6 +30,11 @@ bool TimeoutTimer::enabled() const
     return enabled_;
 }
 
+u64 TimeoutTimer::deadline() const
+{
+    return startTime_ + time_ * 1000;
+}
+
 
 void TimeoutTimer::fire()
 {
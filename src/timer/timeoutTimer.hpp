@@ -13,6 +13,7 @@ public:
     void run() override;
     void cancel() override;
     bool enabled() const override;
+    u64 deadline() const override;
 
 protected:
     void fire() override;
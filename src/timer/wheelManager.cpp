@@ -0,0 +1,490 @@
+#include "timer/wheelManager.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "hal/time/time.hpp"
+
+namespace timer
+{
+
+const std::size_t WheelManager::DefaultCapacity = 16;
+
+// TimerPtr interface over an entry. The entry's callback holds the timer and detaches it when
+// the entry is released, so the timer may outlive its manager.
+class WheelManager::Timer : public ITimer
+{
+public:
+    Timer(WheelManager& manager, TimerCallback callback, const int times)
+        : manager_(&manager), callback_(std::move(callback)), enabled_(true), times_(times)
+    {
+    }
+
+    // expiry is driven by WheelManager::run
+    void run() override
+    {
+    }
+
+    void cancel() override
+    {
+        enabled_ = false;
+        if (nullptr != manager_)
+        {
+            // releasing the entry detaches this timer
+            Handle handle = handle_;
+            manager_->cancel(handle);
+        }
+    }
+
+    bool enabled() const override
+    {
+        return enabled_;
+    }
+
+    u64 deadline() const override
+    {
+        const Entry* entry = nullptr != manager_ ? manager_->find(handle_) : nullptr;
+        return nullptr != entry ? entry->deadline * 1000 : 0;
+    }
+
+    void fire() override
+    {
+        if (enabled_)
+        {
+            if (-1 != times_)
+            {
+                --times_;
+            }
+
+            if (times_ == 0)
+            {
+                enabled_ = false;
+            }
+
+            callback_();
+        }
+    }
+
+    void detach()
+    {
+        enabled_ = false;
+        manager_ = nullptr;
+    }
+
+    WheelManager* manager_;
+    Handle handle_;
+    TimerCallback callback_;
+    bool enabled_;
+    int times_;
+};
+
+struct WheelManager::TimerForwarder
+{
+    explicit TimerForwarder(std::shared_ptr<Timer> timer) : timer(std::move(timer))
+    {
+    }
+
+    ~TimerForwarder()
+    {
+        if (timer)
+        {
+            timer->detach();
+        }
+    }
+
+    TimerForwarder(TimerForwarder&& other) noexcept : timer(std::move(other.timer))
+    {
+    }
+
+    TimerForwarder(const TimerForwarder&) = delete;
+    TimerForwarder& operator=(const TimerForwarder&&) = delete;
+    TimerForwarder& operator=(const TimerForwarder&) = delete;
+
+    void operator()()
+    {
+        timer->fire();
+    }
+
+    std::shared_ptr<Timer> timer;
+};
+
+WheelManager::WheelManager(const std::size_t capacity)
+    : occupied_(), now_(hal::time::nowMilliseconds()), free_(nullptr), available_(0)
+{
+    for (auto& level : wheel_)
+    {
+        for (auto& slot : level)
+        {
+            init(slot);
+        }
+    }
+    init(overflow_);
+    init(expired_);
+    reserve(capacity);
+}
+
+WheelManager::~WheelManager()
+{
+    for (auto& level : wheel_)
+    {
+        for (auto& slot : level)
+        {
+            clear(slot);
+        }
+    }
+    clear(overflow_);
+    clear(expired_);
+}
+
+ITimer::TimerPtr WheelManager::setTimeout(u32 milliseconds, ITimer::TimerCallback callback)
+{
+    return setInterval(milliseconds, std::move(callback), 1);
+}
+
+ITimer::TimerPtr WheelManager::setInterval(u32 milliseconds, ITimer::TimerCallback callback)
+{
+    return setInterval(milliseconds, std::move(callback), -1);
+}
+
+ITimer::TimerPtr WheelManager::setInterval(u32 milliseconds, ITimer::TimerCallback callback,
+                                           int times)
+{
+    auto timer = std::make_shared<Timer>(*this, std::move(callback), times);
+    timer->handle_ = start(milliseconds, TimerForwarder(timer), times);
+    return timer;
+}
+
+Handle WheelManager::arm(u32 milliseconds, Callback callback)
+{
+    return start(milliseconds, std::move(callback), 1);
+}
+
+void WheelManager::cancel(Handle& handle)
+{
+    Entry* entry = find(handle);
+    handle = Handle{};
+    if (nullptr == entry)
+    {
+        return;
+    }
+
+    // callback which is running is released by run() once it returns
+    if (State::Firing == entry->state)
+    {
+        entry->state = State::Cancelled;
+    }
+    else if (State::Armed == entry->state)
+    {
+        unlink(*entry);
+        release(*entry);
+    }
+}
+
+bool WheelManager::armed(const Handle handle) const
+{
+    const Entry* entry = find(handle);
+    return nullptr != entry &&
+           (State::Armed == entry->state || (State::Firing == entry->state && 0 != entry->times));
+}
+
+void WheelManager::run()
+{
+    advance(hal::time::nowMilliseconds());
+
+    // timers which expire during callbacks wait for next run, same as with Manager
+    Slot due;
+    init(due);
+    splice(expired_, due);
+    while (!empty(due))
+    {
+        Entry& entry = static_cast<Entry&>(*due.next);
+        unlink(entry);
+        if (-1 != entry.times)
+        {
+            --entry.times;
+        }
+
+        entry.state = State::Firing;
+        entry.callback();
+        if (State::Cancelled == entry.state || 0 == entry.times)
+        {
+            release(entry);
+            continue;
+        }
+        entry.state = State::Armed;
+        entry.deadline = hal::time::roundUpToMilliseconds(hal::time::now()) + entry.period;
+        schedule(entry);
+    }
+}
+
+u32 WheelManager::timeToNextDeadline() const
+{
+    if (!empty(expired_))
+    {
+        return 0;
+    }
+
+    // timers on higher levels are reported when they are due to move down, that is earlier
+    const u64 event = nextEvent();
+    if (std::numeric_limits<u64>::max() == event)
+    {
+        return NoDeadline;
+    }
+    // callbacks may have run since the loop ticked
+    const u64 now = hal::time::microseconds();
+    const u64 due = event * 1000;
+    return due > now ? static_cast<u32>(std::min<u64>(hal::time::roundUpToMilliseconds(due - now),
+                                                      NoDeadline - 1))
+                     : 0;
+}
+
+void WheelManager::reserve(const std::size_t timers)
+{
+    if (timers > available_)
+    {
+        grow(timers - available_);
+    }
+}
+
+std::size_t WheelManager::capacity() const
+{
+    return entries_.size();
+}
+
+std::size_t WheelManager::available() const
+{
+    return available_;
+}
+
+Handle WheelManager::start(u32 milliseconds, Callback callback, int times)
+{
+    Entry& entry = acquire();
+    entry.callback = std::move(callback);
+    // slots are whole milliseconds, started part of the current one doesn't count
+    entry.deadline = hal::time::roundUpToMilliseconds(hal::time::now()) + milliseconds;
+    entry.period = milliseconds;
+    entry.times = times;
+    entry.state = State::Armed;
+    schedule(entry);
+    return Handle{entry.index, entry.generation};
+}
+
+WheelManager::Entry* WheelManager::find(const Handle handle) const
+{
+    if (handle.index >= entries_.size())
+    {
+        return nullptr;
+    }
+    Entry* entry = entries_[handle.index];
+    return entry->generation == handle.generation && State::Free != entry->state ? entry
+                                                                                 : nullptr;
+}
+
+WheelManager::Entry& WheelManager::acquire()
+{
+    if (nullptr == free_)
+    {
+        grow(EntriesPerBlock);
+    }
+    Entry& entry = static_cast<Entry&>(*free_);
+    free_ = free_->next;
+    --available_;
+    return entry;
+}
+
+void WheelManager::release(Entry& entry)
+{
+    // stale handles stop matching before callback's captures are destroyed,
+    // their destructors may use the manager
+    entry.state = State::Free;
+    // generation 0 is left for empty handle
+    if (0 == ++entry.generation)
+    {
+        entry.generation = 1;
+    }
+    entry.callback.reset();
+
+    entry.prev = nullptr;
+    entry.next = free_;
+    free_ = &entry;
+    ++available_;
+}
+
+void WheelManager::grow(const std::size_t entries)
+{
+    blocks_.emplace_back(new Entry[entries]);
+    Entry* block = blocks_.back().get();
+    // lower indexes are handed out first
+    for (std::size_t i = entries; i-- > 0;)
+    {
+        Entry& entry = block[i];
+        entry.index = static_cast<u32>(entries_.size() + i);
+        entry.generation = 1;
+        entry.state = State::Free;
+        entry.prev = nullptr;
+        entry.next = free_;
+        free_ = &entry;
+    }
+    for (std::size_t i = 0; i < entries; ++i)
+    {
+        entries_.push_back(&block[i]);
+    }
+    available_ += entries;
+}
+
+void WheelManager::schedule(Entry& entry)
+{
+    if (entry.deadline <= now_)
+    {
+        link(expired_, entry);
+        return;
+    }
+
+    // level is given by highest digit in which deadline differs from current time
+    const u64 distance = entry.deadline ^ now_;
+    const unsigned level = (63 - __builtin_clzll(distance)) / SlotBits;
+    if (level >= Levels)
+    {
+        link(overflow_, entry);
+        return;
+    }
+
+    const unsigned slot = (entry.deadline >> (level * SlotBits)) & (Slots - 1);
+    link(wheel_[level][slot], entry);
+    occupied_[level] |= u64(1) << slot;
+}
+
+void WheelManager::advance(const u64 now)
+{
+    while (now_ < now)
+    {
+        const u64 event = nextEvent();
+        if (event > now)
+        {
+            now_ = now;
+            return;
+        }
+        now_ = event;
+
+        if (0 == (event & ((u64(1) << (Levels * SlotBits)) - 1)))
+        {
+            cascade(overflow_);
+        }
+
+        // higher levels first, their timers may land in lower slots of the same time
+        for (unsigned level = Levels; level-- > 0;)
+        {
+            const unsigned shift = level * SlotBits;
+            if (0 != (event & ((u64(1) << shift) - 1)))
+            {
+                continue;
+            }
+
+            const unsigned slot = (event >> shift) & (Slots - 1);
+            const u64 bit = u64(1) << slot;
+            if (occupied_[level] & bit)
+            {
+                occupied_[level] &= ~bit;
+                if (0 == level)
+                {
+                    splice(wheel_[0][slot], expired_);
+                }
+                else
+                {
+                    cascade(wheel_[level][slot]);
+                }
+            }
+        }
+    }
+}
+
+u64 WheelManager::nextEvent() const
+{
+    // slot of each level is reached when lower digits of current time roll over to zero.
+    // Cancelled timers leave their slot marked, such slot is only visited and cleared.
+    u64 event = std::numeric_limits<u64>::max();
+    for (unsigned level = 0; level < Levels; ++level)
+    {
+        if (0 != occupied_[level])
+        {
+            const unsigned shift = level * SlotBits;
+            const u64 slot = __builtin_ctzll(occupied_[level]);
+            const u64 span = u64(1) << (shift + SlotBits);
+            event = std::min(event, (now_ & ~(span - 1)) | (slot << shift));
+        }
+    }
+
+    if (!empty(overflow_))
+    {
+        const u64 span = u64(1) << (Levels * SlotBits);
+        event = std::min(event, (now_ & ~(span - 1)) + span);
+    }
+    return event;
+}
+
+void WheelManager::cascade(Slot& slot)
+{
+    Slot pending;
+    init(pending);
+    splice(slot, pending);
+    while (!empty(pending))
+    {
+        Entry& entry = static_cast<Entry&>(*pending.next);
+        unlink(entry);
+        schedule(entry);
+    }
+}
+
+void WheelManager::clear(Slot& slot)
+{
+    while (!empty(slot))
+    {
+        Entry& entry = static_cast<Entry&>(*slot.next);
+        unlink(entry);
+        release(entry);
+    }
+}
+
+void WheelManager::init(Slot& slot)
+{
+    slot.prev = &slot;
+    slot.next = &slot;
+}
+
+bool WheelManager::empty(const Slot& slot)
+{
+    return slot.next == &slot;
+}
+
+void WheelManager::link(Slot& slot, Node& node)
+{
+    node.prev = slot.prev;
+    node.next = &slot;
+    slot.prev->next = &node;
+    slot.prev = &node;
+}
+
+void WheelManager::unlink(Node& node)
+{
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = nullptr;
+    node.next = nullptr;
+}
+
+void WheelManager::splice(Slot& from, Slot& to)
+{
+    if (empty(from))
+    {
+        return;
+    }
+
+    from.next->prev = to.prev;
+    to.prev->next = from.next;
+    from.prev->next = &to;
+    to.prev = from.prev;
+    init(from);
+}
+
+} // namespace timer
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "timer/IManager.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "utils/types.hpp"
+
+namespace timer
+{
+
+/* Hierarchical timing wheel: timers are kept in slots by their deadline instead of being
+ * polled, so setting and cancelling a timer is O(1) and run() only touches expired ones.
+ * Timers live in blocks which are kept until the manager is destroyed, so once it grew to
+ * cover timers in use, arm() and firing don't touch the heap. Callbacks behave as with Manager.
+ */
+class WheelManager : public IManager
+{
+public:
+    static const std::size_t DefaultCapacity;
+
+    explicit WheelManager(std::size_t capacity = DefaultCapacity);
+    ~WheelManager();
+    WheelManager(const WheelManager&) = delete;
+    WheelManager(const WheelManager&&) = delete;
+    WheelManager& operator=(const WheelManager&&) = delete;
+    WheelManager& operator=(const WheelManager&) = delete;
+
+    ITimer::TimerPtr setTimeout(u32 milliseconds, ITimer::TimerCallback callback) override;
+    ITimer::TimerPtr setInterval(u32 milliseconds, ITimer::TimerCallback callback) override;
+    ITimer::TimerPtr setInterval(u32 milliseconds, ITimer::TimerCallback callback,
+                                 int times) override;
+
+    Handle arm(u32 milliseconds, Callback callback) override;
+    void cancel(Handle& handle) override;
+    bool armed(Handle handle) const override;
+
+    void run() override;
+    u32 timeToNextDeadline() const override;
+
+    // Makes sure that given number of timers may be armed without growing
+    void reserve(std::size_t timers);
+    std::size_t capacity() const;
+    std::size_t available() const;
+
+private:
+    // 64 slots of 1 ms, 64 ms, 4 s and 4.4 min, longer timers wait in overflow
+    static const unsigned SlotBits = 6;
+    static const unsigned Slots = 1 << SlotBits;
+    static const unsigned Levels = 4;
+    // entries added at once when all are in use
+    static const std::size_t EntriesPerBlock = 16;
+
+    struct Node
+    {
+        Node* prev;
+        Node* next;
+    };
+
+    enum class State : u8
+    {
+        Free,
+        Armed,
+        Firing,
+        Cancelled
+    };
+
+    struct Entry : Node
+    {
+        Callback callback;
+        u64 deadline;
+        u32 period;
+        u32 index;
+        u32 generation;
+        int times;
+        State state;
+    };
+
+    class Timer;
+    struct TimerForwarder;
+    using Slot = Node;
+    using Level = std::array<Slot, Slots>;
+
+    Handle start(u32 milliseconds, Callback callback, int times);
+    Entry* find(Handle handle) const;
+    Entry& acquire();
+    void release(Entry& entry);
+    void grow(std::size_t entries);
+
+    void schedule(Entry& entry);
+    void advance(u64 now);
+    u64 nextEvent() const;
+    void cascade(Slot& slot);
+    void clear(Slot& slot);
+
+    static void init(Slot& slot);
+    static bool empty(const Slot& slot);
+    static void link(Slot& slot, Node& node);
+    static void unlink(Node& node);
+    static void splice(Slot& from, Slot& to);
+
+    std::array<Level, Levels> wheel_;
+    std::array<u64, Levels> occupied_;
+    Slot overflow_;
+    Slot expired_;
+    u64 now_;
+    std::vector<std::unique_ptr<Entry[]>> blocks_;
+    // handle index to entry
+    std::vector<Entry*> entries_;
+    // free entries are chained through Node::next
+    Node* free_;
+    std::size_t available_;
+};
+
+} // namespace timer
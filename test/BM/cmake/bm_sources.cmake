@@ -0,0 +1,37 @@
+set(BM_SRC_DIR "${PROJECT_SOURCE_DIR}/test/BM/src")
+set(X86_SRC_DIR "${PROJECT_SOURCE_DIR}/src/hal/x86")
+
+set(bm_srcs
+    ${BM_SRC_DIR}/bench/protocol/crcBenchmarks.cpp
+    ${BM_SRC_DIR}/bench/protocol/frameHandlerBenchmarks.cpp
+    ${BM_SRC_DIR}/bench/protocol/packetAssemblerBenchmarks.cpp
+    ${BM_SRC_DIR}/bench/protocol/packetHandlerBenchmarks.cpp
+    ${BM_SRC_DIR}/bench/timer/managerBenchmarks.cpp
+    ${BM_SRC_DIR}/benchmarkMain.cpp
+
+    ${BM_SRC_DIR}/helper/benchmark.cpp
+    ${BM_SRC_DIR}/helper/simulatedLink.cpp
+
+    ${BM_SRC_DIR}/stub/simulatedClock.cpp
+)
+
+set(bm_incs
+    ${BM_SRC_DIR}/helper/benchmark.hpp
+    ${BM_SRC_DIR}/helper/simulatedLink.hpp
+
+    ${BM_SRC_DIR}/stub/simulatedClock.hpp
+)
+
+set(bm_target_srcs
+    ${X86_SRC_DIR}/fs/file_x86.cpp
+    ${X86_SRC_DIR}/fs/filesystem_x86.cpp
+    ${X86_SRC_DIR}/net/http/asyncHttpServer_x86.cpp
+    ${X86_SRC_DIR}/net/http/httpConnection_x86.cpp
+    ${X86_SRC_DIR}/net/socket/tcpClient_x86.cpp
+    ${X86_SRC_DIR}/net/socket/tcpServer_x86.cpp
+    ${X86_SRC_DIR}/net/socket/tcpSession.cpp
+    ${X86_SRC_DIR}/net/socket/websocket_x86.cpp
+    ${X86_SRC_DIR}/serial/serialPort_x86.cpp
+    ${X86_SRC_DIR}/time/sleep_x86.cpp
+    ${X86_SRC_DIR}/time/time_x86.cpp
+)
@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <string>
+
+#include <CRC.h>
+
+#include "helper/benchmark.hpp"
+#include "protocol/crc.hpp"
+
+namespace
+{
+
+using Crc16Bytewise = protocol::crc::ReflectedCrc<u16, 0xa001, 0x0000, 0x0000,
+                                                  protocol::crc::NoAccelerator, 1>;
+using Crc16Sliced = protocol::crc::ReflectedCrc<u16, 0xa001, 0x0000, 0x0000,
+                                                protocol::crc::NoAccelerator, 8>;
+using Crc32Sliced = protocol::crc::ReflectedCrc<u32, 0xedb88320, 0xffffffff, 0xffffffff,
+                                                protocol::crc::NoAccelerator, 8>;
+using Crc32Folded = protocol::crc::ReflectedCrc<u32, 0xedb88320, 0xffffffff, 0xffffffff,
+                                                protocol::crc::Pclmul, 8>;
+
+const std::size_t payloadSizes[] = {8, 247, 4096, 62738};
+const u64 bytesPerMeasurement = 16 * 1024 * 1024;
+
+DataBuffer createPayload(std::size_t size)
+{
+    DataBuffer payload(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        payload[i] = static_cast<u8>(i * 31 + 7);
+    }
+    return payload;
+}
+
+template <typename Function>
+std::string bytesPerCycle(const DataBuffer& payload, Function function)
+{
+    const u64 iterations = bytesPerMeasurement / payload.size();
+    // warm up caches and branch predictors
+    benchmark::measure(iterations / 16 + 1, function);
+    const auto result = benchmark::measure(iterations, function);
+
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%8.3f B/cycle %10.1f MB/s",
+                  static_cast<double>(payload.size() * iterations) / result.cycles,
+                  static_cast<double>(payload.size() * iterations) * 1000.0 / result.nanoseconds);
+    return buffer;
+}
+
+} // namespace
+
+BENCHMARK(Crc16Arc)
+{
+    for (const auto size : payloadSizes)
+    {
+        const auto payload = createPayload(size);
+        const auto prefix = "CRC-16/ARC " + std::to_string(size) + "B ";
+
+        benchmark::report(prefix + "CRCpp CRC::Calculate", bytesPerCycle(payload, [&payload]() {
+                              benchmark::doNotOptimize(CRC::Calculate(
+                                  payload.data(), payload.size(), CRC::CRC_16_ARC()));
+                          }));
+        benchmark::report(prefix + "slice-by-1", bytesPerCycle(payload, [&payload]() {
+                              benchmark::doNotOptimize(Crc16Bytewise::calculate(payload));
+                          }));
+        benchmark::report(prefix + "slice-by-8", bytesPerCycle(payload, [&payload]() {
+                              benchmark::doNotOptimize(Crc16Sliced::calculate(payload));
+                          }));
+    }
+}
+
+BENCHMARK(Crc32)
+{
+    std::printf("    PCLMULQDQ %s\n", protocol::crc::Pclmul::supported() ? "available" : "missing");
+    for (const auto size : payloadSizes)
+    {
+        const auto payload = createPayload(size);
+        const auto prefix = "CRC-32 " + std::to_string(size) + "B ";
+
+        benchmark::report(prefix + "CRCpp CRC::Calculate", bytesPerCycle(payload, [&payload]() {
+                              benchmark::doNotOptimize(
+                                  CRC::Calculate(payload.data(), payload.size(), CRC::CRC_32()));
+                          }));
+        benchmark::report(prefix + "slice-by-8", bytesPerCycle(payload, [&payload]() {
+                              benchmark::doNotOptimize(Crc32Sliced::calculate(payload));
+                          }));
+        benchmark::report(prefix + "slice-by-8 + PCLMUL", bytesPerCycle(payload, [&payload]() {
+                              benchmark::doNotOptimize(Crc32Folded::calculate(payload));
+                          }));
+    }
+}
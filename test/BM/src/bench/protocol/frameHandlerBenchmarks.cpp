@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dispatcher/IDataReceiver.hpp"
+#include "helper/benchmark.hpp"
+#include "protocol/frameEncoder.hpp"
+#include "protocol/frameHandler.hpp"
+#include "protocol/stuffer.hpp"
+
+namespace
+{
+
+const u16 Port = 1;
+const std::size_t Frames = 4096;
+const std::size_t Errors = 256;
+const std::size_t FramePayloadSize = 64;
+// bytes handed to handler by single UART read
+const std::size_t ReadSize = 32;
+const u64 bytesPerMeasurement = 16 * 1024 * 1024;
+
+// Replies go nowhere, data is pushed directly into handler
+struct Connection : public dispatcher::IDataReceiver
+{
+    void setHandler(const ReaderCallback& callback) override
+    {
+        readerCallback = callback;
+    }
+    void write(const std::string& /*data*/) override
+    {
+    }
+    void write(const BufferSpan& /*buffer*/) override
+    {
+    }
+    void write(u8 /*byte*/) override
+    {
+    }
+
+    ReaderCallback readerCallback;
+};
+
+struct Stream
+{
+    DataBuffer data;
+    std::vector<std::size_t> frameOffsets;
+};
+
+Stream createStream(const bool stuffed, const std::size_t payloadSize, std::mt19937& random)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    DataBuffer payload(payloadSize);
+    DataBuffer encoded(payloadSize + protocol::FrameOverhead);
+    DataBuffer frameStuffed(protocol::maxStuffedSize(encoded.size()));
+    Stream stream;
+    for (std::size_t i = 0; i < Frames; ++i)
+    {
+        stream.frameOffsets.push_back(stream.data.size());
+        for (auto& data : payload)
+        {
+            data = static_cast<u8>(byte(random));
+        }
+        protocol::Frame<> frame(Port, static_cast<u8>(i));
+        frame.control(protocol::messages::Control::Transmission);
+        frame.payload(payload.data(), static_cast<u16>(payload.size()));
+        const std::size_t size = protocol::encode(frame, encoded);
+        if (!stuffed)
+        {
+            stream.data.insert(stream.data.end(), encoded.begin(), encoded.begin() + size);
+            continue;
+        }
+        const std::size_t stuffedSize =
+            protocol::stuff(BufferSpan{encoded.data(), static_cast<BufferIndexType>(size)},
+                            frameStuffed);
+        stream.data.insert(stream.data.end(), frameStuffed.begin(),
+                           frameStuffed.begin() + stuffedSize);
+        stream.data.push_back(protocol::Delimiter);
+    }
+    return stream;
+}
+
+void feed(Connection& connection, const DataBuffer& data, const std::size_t readSize)
+{
+    for (std::size_t offset = 0; offset < data.size(); offset += readSize)
+    {
+        const std::size_t size = std::min(readSize, data.size() - offset);
+        connection.readerCallback(BufferSpan{&data[offset], static_cast<BufferIndexType>(size)},
+                                  defaultWriter);
+    }
+}
+
+// Frames lost because of single damaged byte, frame which holds it included. Damaged length
+// field is the worst case for start byte search, parser swallows following frames.
+double framesLostPerError(const bool stuffed, const bool lengthOnly)
+{
+    std::mt19937 random(1234);
+    Stream stream = createStream(stuffed, FramePayloadSize, random);
+    DataBuffer& data = stream.data;
+    std::uniform_int_distribution<std::size_t> position(0, data.size() - 1);
+    std::uniform_int_distribution<std::size_t> frame(0, Frames - 1);
+    std::uniform_int_distribution<int> bits(1, 255);
+    // stuffed frame starts with code byte
+    const std::size_t lengthOffset = stuffed ? 2 : 1;
+    for (std::size_t i = 0; i < Errors; ++i)
+    {
+        const std::size_t damaged =
+            lengthOnly ? stream.frameOffsets[frame(random)] + lengthOffset : position(random);
+        data[damaged] ^= static_cast<u8>(bits(random));
+    }
+
+    const auto connection = std::make_shared<Connection>();
+    protocol::FrameHandler handler;
+    handler.setConnection(connection);
+    handler.setStuffing(stuffed);
+    std::size_t received = 0;
+    handler.connect(Port, [&received](const protocol::FrameView& /*frame*/) { ++received; });
+
+    feed(*connection, data, ReadSize);
+    return static_cast<double>(Frames - received) / Errors;
+}
+
+template <typename Function>
+std::string bytesPerCycle(const std::size_t size, Function function)
+{
+    const u64 iterations = bytesPerMeasurement / size;
+    benchmark::measure(iterations / 16 + 1, function);
+    const auto result = benchmark::measure(iterations, function);
+
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%8.3f B/cycle %10.1f MB/s",
+                  static_cast<double>(size * iterations) / result.cycles,
+                  static_cast<double>(size * iterations) * 1000.0 / result.nanoseconds);
+    return buffer;
+}
+
+} // namespace
+
+BENCHMARK(FrameResynchronisation)
+{
+    std::printf("    %zu frames of %zuB random payload, %zu damaged bytes, %zuB reads\n", Frames,
+                FramePayloadSize, Errors, ReadSize);
+    for (const bool lengthOnly : {false, true})
+    {
+        for (const bool stuffed : {false, true})
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%6.2f frames lost per error",
+                          framesLostPerError(stuffed, lengthOnly));
+            benchmark::report(std::string(lengthOnly ? "length byte" : "any byte") +
+                                  (stuffed ? ", COBS zero delimiter" : ", start byte search"),
+                              buffer);
+        }
+    }
+}
+
+BENCHMARK(Cobs)
+{
+    for (const std::size_t size : {std::size_t{247}, std::size_t{4096}})
+    {
+        DataBuffer data(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            data[i] = static_cast<u8>(i * 31 + 7);
+        }
+        DataBuffer output(protocol::maxStuffedSize(size));
+        DataBuffer stuffed(output.size());
+        stuffed.resize(protocol::stuff(data, stuffed));
+        DataBuffer unstuffed(size);
+
+        const auto prefix = std::to_string(size) + "B ";
+        benchmark::report(prefix + "stuff", bytesPerCycle(size, [&data, &output]() {
+                              benchmark::doNotOptimize(protocol::stuff(data, output));
+                          }));
+        benchmark::report(prefix + "unstuff", bytesPerCycle(size, [&stuffed, &unstuffed]() {
+                              benchmark::doNotOptimize(protocol::unstuff(stuffed, unstuffed));
+                          }));
+    }
+}
+
+// Whole frames in read are parsed in place, byte reads force state machine
+BENCHMARK(FrameHandlerParse)
+{
+    std::printf("    capture of %zu frames, replies discarded\n", Frames);
+    for (const std::size_t payloadSize : {std::size_t{16}, std::size_t{247}})
+    {
+        std::mt19937 random(1234);
+        const Stream capture = createStream(false, payloadSize, random);
+        for (const std::size_t readSize : {std::size_t{1}, std::size_t{64}, std::size_t{4096}})
+        {
+            const auto connection = std::make_shared<Connection>();
+            protocol::FrameHandler handler;
+            handler.setConnection(connection);
+            std::size_t received = 0;
+            handler.connect(Port, [&received](const protocol::FrameView& /*frame*/) { ++received; });
+
+            const u64 iterations = bytesPerMeasurement / capture.data.size() + 1;
+            const auto parse = [&connection, &capture, readSize]() {
+                feed(*connection, capture.data, readSize);
+            };
+            benchmark::measure(1, parse);
+            const auto result = benchmark::measure(iterations, parse);
+
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%10.0f frames/s %8.3f B/cycle",
+                          static_cast<double>(Frames * iterations) * 1e9 / result.nanoseconds,
+                          static_cast<double>(capture.data.size() * iterations) / result.cycles);
+            benchmark::report(std::to_string(payloadSize) + "B frames, " +
+                                  std::to_string(readSize) + "B reads",
+                              received == Frames * (iterations + 1) ? buffer : "frames lost");
+        }
+    }
+}
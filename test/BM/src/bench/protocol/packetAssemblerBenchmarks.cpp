@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <string>
+
+#include "helper/benchmark.hpp"
+#include "protocol/crc.hpp"
+#include "protocol/frame.hpp"
+#include "protocol/packetAssembler.hpp"
+#include "serializer/serializer.hpp"
+
+namespace
+{
+
+const std::size_t packetSizes[] = {247, 4096, 62738};
+const u64 bytesPerMeasurement = 16 * 1024 * 1024;
+
+struct Frames
+{
+    DataBuffer header;
+    DataBuffer packet;
+    DataBuffer crc;
+    std::vector<BufferSpan> data;
+};
+
+Frames createFrames(std::size_t size)
+{
+    Frames frames;
+    frames.packet.resize(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        frames.packet[i] = static_cast<u8>(i * 31 + 7);
+    }
+
+    frames.header.resize(6);
+    serializer::serialize(frames.header.data(), static_cast<u16>(size));
+    serializer::serialize(&frames.header[4],
+                          protocol::crc::Crc16Arc::calculate(BufferSpan{frames.header.data(), 4}));
+
+    frames.crc.resize(4);
+    serializer::serialize(frames.crc.data(), protocol::crc::Crc32::calculate(frames.packet));
+
+    for (std::size_t offset = 0; offset < size; offset += protocol::MaxPayloadSize)
+    {
+        const std::size_t length = std::min<std::size_t>(protocol::MaxPayloadSize, size - offset);
+        frames.data.emplace_back(&frames.packet[offset], static_cast<BufferIndexType>(length));
+    }
+    return frames;
+}
+
+std::string bytesPerCycle(const Frames& frames, const bool reversed)
+{
+    protocol::PacketAssembler assembler;
+    std::size_t delivered = 0;
+    assembler.setReceiver(
+        [&delivered](u16 /*port*/, const BufferSpan& packet) { delivered += packet.size(); });
+
+    const auto dataFrames = static_cast<u8>(frames.data.size());
+    const auto assemble = [&]() {
+        assembler.append(1, 0, frames.header);
+        for (u8 i = 0; i < dataFrames; ++i)
+        {
+            const u8 number = reversed ? static_cast<u8>(dataFrames - i) : static_cast<u8>(i + 1);
+            assembler.append(1, number, frames.data[number - 1]);
+        }
+        assembler.append(1, static_cast<u8>(dataFrames + 1), frames.crc);
+    };
+
+    const u64 iterations = bytesPerMeasurement / frames.packet.size();
+    benchmark::measure(iterations / 16 + 1, assemble);
+    const auto result = benchmark::measure(iterations, assemble);
+    benchmark::doNotOptimize(delivered);
+
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%8.3f B/cycle %10.1f MB/s",
+                  static_cast<double>(frames.packet.size() * iterations) / result.cycles,
+                  static_cast<double>(frames.packet.size() * iterations) * 1000.0 /
+                      result.nanoseconds);
+    return buffer;
+}
+
+} // namespace
+
+// includes CRC-32 verification of whole packet
+BENCHMARK(PacketAssembly)
+{
+    for (const auto size : packetSizes)
+    {
+        const auto frames = createFrames(size);
+        const auto prefix = std::to_string(size) + "B packet ";
+        benchmark::report(prefix + "frames in order", bytesPerCycle(frames, false));
+        benchmark::report(prefix + "frames reversed", bytesPerCycle(frames, true));
+    }
+}
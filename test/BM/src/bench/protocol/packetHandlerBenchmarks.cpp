@@ -0,0 +1,420 @@
+#include <cstdio>
+#include <string>
+
+#include "container/buffer.hpp"
+#include "helper/benchmark.hpp"
+#include "helper/simulatedLink.hpp"
+#include "protocol/packetHandler.hpp"
+#include "serializer/serializer.hpp"
+#include "stub/simulatedClock.hpp"
+#include "timer/manager.hpp"
+
+namespace
+{
+
+const u16 Port = 1;
+const std::size_t PacketSize = 4096;
+const std::size_t Packets = 32;
+// simulated time is kept in microseconds
+const u64 Step = 1000;
+const u64 TimeLimit = 600000000;
+const u32 Baudrate = 115200;
+const u32 Latency = 20000; // one way
+const u32 DelayedAckTime = 50; // milliseconds
+
+struct Transfer
+{
+    u64 duration;
+    u64 bytesReceived;
+    u64 packetsDropped;
+    u64 bytesSent;
+    u64 bytesSentBack;
+    u64 writesLost;
+    u64 writesCorrupted;
+    u32 rtt;
+    u32 rto;
+};
+
+Transfer transfer(const u8 windowSize, const double lossRate, const double corruptionRate,
+                  const u8 delayedAckFrames = 0)
+{
+    stub::time::setCurrentTime(0);
+    helper::SimulatedLink link({Baudrate, Latency, lossRate, corruptionRate, 1234});
+    timer::Manager timerManager;
+    protocol::PacketHandler sender(Port, link.first(), timerManager);
+    protocol::PacketHandler receiver(Port, link.second(), timerManager);
+
+    u64 bytesReceived = 0;
+    u64 packetsReceived = 0;
+    u64 packetsDropped = 0;
+    receiver.setPacketReceiver([&bytesReceived, &packetsReceived](const BufferSpan& packet) {
+        bytesReceived += packet.size();
+        ++packetsReceived;
+    });
+    sender.setFailureHandler([&packetsDropped](u8 /*messageNumber*/) { ++packetsDropped; });
+
+    sender.setMaxWindowSize(windowSize);
+    receiver.setMaxWindowSize(windowSize);
+    receiver.setDelayedAck(delayedAckFrames, DelayedAckTime);
+    sender.negotiateWindowSize();
+    // whole transfer is queued upfront
+    sender.setQueueLimit(protocol::Priority::Normal, Packets * PacketSize);
+
+    DataBuffer packet(PacketSize);
+    for (std::size_t i = 0; i < PacketSize; ++i)
+    {
+        packet[i] = static_cast<u8>(i);
+    }
+    for (std::size_t i = 0; i < Packets; ++i)
+    {
+        sender.send(packet);
+    }
+
+    while (packetsReceived + packetsDropped < Packets && stub::time::microseconds() < TimeLimit)
+    {
+        stub::time::forwardTime(Step);
+        link.run();
+        timerManager.run();
+    }
+    return Transfer{stub::time::microseconds(), bytesReceived,        packetsDropped,
+                    link.bytesSent(),           link.bytesSentBack(), link.writesLost(),
+                    link.writesCorrupted(),     sender.rtt(),         sender.rto()};
+}
+
+std::string describe(const Transfer& result)
+{
+    const double lineRate = static_cast<double>(Baudrate) / 10;
+    const double goodput = static_cast<double>(result.bytesReceived) * 1000000 / result.duration;
+
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer),
+                  "%8.0f B/s %5.1f%% of line, %3llu writes damaged, %llu packets dropped, "
+                  "rtt %4u ms, rto %4u ms",
+                  goodput, goodput * 100 / lineRate,
+                  static_cast<unsigned long long>(result.writesLost + result.writesCorrupted),
+                  static_cast<unsigned long long>(result.packetsDropped), result.rtt, result.rto);
+    return buffer;
+}
+
+// Time between queueing of small command behind bulk transfer and its delivery, microseconds
+u64 commandLatency(const protocol::Priority priority)
+{
+    const std::size_t CommandSize = 64;
+    const u64 CommandSentAt = 500000;
+
+    stub::time::setCurrentTime(0);
+    helper::SimulatedLink link({Baudrate, Latency, 0, 0, 1234});
+    timer::Manager timerManager;
+    protocol::PacketHandler sender(Port, link.first(), timerManager);
+    protocol::PacketHandler receiver(Port, link.second(), timerManager);
+    sender.setMaxWindowSize(8);
+    receiver.setMaxWindowSize(8);
+    sender.negotiateWindowSize();
+
+    u64 deliveredAt = 0;
+    receiver.setPacketReceiver([&deliveredAt](const BufferSpan& packet) {
+        if (packet.size() == CommandSize)
+        {
+            deliveredAt = stub::time::microseconds();
+        }
+    });
+
+    const DataBuffer bulk(PacketSize, 0x55);
+    for (int i = 0; i < 8; ++i)
+    {
+        sender.send(bulk);
+    }
+
+    bool commandSent = false;
+    while (deliveredAt == 0 && stub::time::microseconds() < TimeLimit)
+    {
+        stub::time::forwardTime(Step);
+        if (!commandSent && stub::time::microseconds() >= CommandSentAt)
+        {
+            sender.send(DataBuffer(CommandSize, 0xaa), priority);
+            commandSent = true;
+        }
+        link.run();
+        timerManager.run();
+    }
+    return deliveredAt - CommandSentAt;
+}
+
+// Same as above, but command goes through its own port sharing the link with bulk transfer
+u64 sharedLinkCommandLatency(const std::size_t burst, const u64 commandSentAt)
+{
+    const std::size_t CommandSize = 64;
+    const u16 CommandPort = Port + 1;
+
+    stub::time::setCurrentTime(0);
+    helper::SimulatedLink link({Baudrate, Latency, 0, 0, 1234});
+    timer::Manager timerManager;
+    protocol::FrameHandler senderLink;
+    senderLink.setConnection(link.first());
+    senderLink.setTransmitBurst(burst);
+    protocol::FrameHandler receiverLink;
+    receiverLink.setConnection(link.second());
+    protocol::PacketHandler bulkSender(Port, senderLink, timerManager);
+    protocol::PacketHandler bulkReceiver(Port, receiverLink, timerManager);
+    protocol::PacketHandler commandSender(CommandPort, senderLink, timerManager);
+    protocol::PacketHandler commandReceiver(CommandPort, receiverLink, timerManager);
+    for (auto* handler : {&bulkSender, &bulkReceiver, &commandSender, &commandReceiver})
+    {
+        handler->setMaxWindowSize(8);
+    }
+    bulkSender.negotiateWindowSize();
+    commandSender.negotiateWindowSize();
+
+    u64 deliveredAt = 0;
+    commandReceiver.setPacketReceiver(
+        [&deliveredAt](const BufferSpan& /*packet*/) { deliveredAt = stub::time::microseconds(); });
+
+    const DataBuffer bulk(PacketSize, 0x55);
+    for (int i = 0; i < 8; ++i)
+    {
+        bulkSender.send(bulk);
+    }
+
+    bool commandSent = false;
+    while (deliveredAt == 0 && stub::time::microseconds() < TimeLimit)
+    {
+        stub::time::forwardTime(Step);
+        if (!commandSent && stub::time::microseconds() >= commandSentAt)
+        {
+            commandSender.send(DataBuffer(CommandSize, 0xaa));
+            commandSent = true;
+        }
+        link.run();
+        timerManager.run();
+    }
+    return deliveredAt - commandSentAt;
+}
+
+struct SlowConsumer
+{
+    u64 duration;
+    u64 bytesConsumed;
+    u64 bytesLost;
+    // by module, without acks and credit updates from MCU
+    u64 bytesSent;
+    u32 stalls;
+};
+
+// MCU copies payload of frames into its ring buffer and processes it slower than line delivers
+SlowConsumer slowConsumer(const bool creditFlowControl)
+{
+    const std::size_t BufferSize = 1024;
+    const u64 ConsumeRate = 2000; // bytes per second
+    const std::size_t TransferPackets = 4;
+
+    stub::time::setCurrentTime(0);
+    helper::SimulatedLink link({Baudrate, Latency, 0, 0, 1234});
+    timer::Manager timerManager;
+    protocol::PacketHandler sender(Port, link.first(), timerManager);
+    protocol::FrameHandler mcu;
+    mcu.setConnection(link.second());
+    container::Buffer<BufferSize> buffer;
+    u64 bytesLost = 0;
+    mcu.connect(Port, [&mcu, &buffer, &bytesLost](const protocol::FrameView& frame) {
+        if (frame.control() == protocol::messages::Control::Transmission)
+        {
+            bytesLost += frame.length() -
+                         buffer.write(gsl::span<const u8>(frame.payload(), frame.length()));
+        }
+        else if (frame.control() == protocol::messages::Control::WindowSizeRequest)
+        {
+            protocol::Frame<1> response(Port, 0);
+            response.control(protocol::messages::Control::WindowSizeResponse);
+            response.payload(frame.payload(), 1);
+            mcu.send(response);
+        }
+    });
+    if (creditFlowControl)
+    {
+        mcu.setReceiveCredit(Port, BufferSize);
+    }
+    sender.setMaxWindowSize(8);
+    sender.negotiateWindowSize();
+
+    std::size_t completed = 0;
+    const DataBuffer packet(PacketSize, 0x55);
+    for (std::size_t i = 0; i < TransferPackets; ++i)
+    {
+        sender.send(packet, protocol::Priority::Normal,
+                    [&completed](bool /*delivered*/) { ++completed; });
+    }
+
+    u64 bytesConsumed = 0;
+    while ((completed < TransferPackets || buffer.size() != 0) &&
+           stub::time::microseconds() < TimeLimit)
+    {
+        stub::time::forwardTime(Step);
+        link.run();
+        timerManager.run();
+
+        const u64 due = stub::time::microseconds() * ConsumeRate / 1000000 - bytesConsumed;
+        const u16 consumed = static_cast<u16>(std::min<u64>(due, buffer.size()));
+        for (u16 i = 0; i < consumed; ++i)
+        {
+            buffer.getByte();
+        }
+        bytesConsumed += consumed;
+        if (creditFlowControl && consumed != 0)
+        {
+            mcu.releaseCredit(Port, consumed);
+        }
+    }
+    return SlowConsumer{stub::time::microseconds(), bytesConsumed, bytesLost,
+                        link.bytesSent() - link.bytesSentBack(), sender.creditStalls()};
+}
+
+// Queueing of packet behind packet in flight, which only splits it into frames
+template <typename Payload>
+std::string sendSpeed(const Payload& payload, const std::size_t size)
+{
+    const u64 iterations = 16 * 1024 * 1024 / size;
+    helper::SimulatedLink link({Baudrate, Latency, 0, 0, 1234});
+    const auto queue = [&link, &payload]() {
+        timer::Manager timerManager;
+        protocol::PacketHandler sender(Port, link.first(), timerManager);
+        sender.send(DataBuffer{});
+        benchmark::doNotOptimize(sender.send(payload));
+    };
+    benchmark::measure(iterations / 16 + 1, queue);
+    const auto result = benchmark::measure(iterations, queue);
+
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%8.3f B/cycle %10.1f MB/s",
+                  static_cast<double>(size * iterations) / result.cycles,
+                  static_cast<double>(size * iterations) * 1000.0 / result.nanoseconds);
+    return buffer;
+}
+
+void printConditions()
+{
+    std::printf("    %zu packets of %zuB, %u baud, %u ms latency, simulated time\n", Packets,
+                PacketSize, Baudrate, Latency / 1000);
+}
+
+} // namespace
+
+BENCHMARK(PacketHandlerGoodput)
+{
+    printConditions();
+    for (const double lossRate : {0.0, 0.01, 0.05})
+    {
+        for (const u8 windowSize : {1, 2, 4, 8, 16})
+        {
+            benchmark::report("loss " + std::to_string(static_cast<int>(lossRate * 100)) +
+                                  "% window " + std::to_string(windowSize),
+                              describe(transfer(windowSize, lossRate, 0)));
+        }
+    }
+}
+
+BENCHMARK(PacketHandlerCommandLatency)
+{
+    std::printf("    64B command queued behind 8 packets of %zuB, window 8, %u baud\n", PacketSize,
+                Baudrate);
+    for (const auto priority : {protocol::Priority::Normal, protocol::Priority::High})
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%8.1f ms",
+                      static_cast<double>(commandLatency(priority)) / 1000);
+        const bool high = priority == protocol::Priority::High;
+        benchmark::report(high ? "high priority" : "normal priority", buffer);
+    }
+}
+
+BENCHMARK(PacketHandlerSharedLink)
+{
+    std::printf("    64B command on own port, 8 packets of %zuB on other port, window 8, %u baud, "
+                "mean of 16 send times\n",
+                PacketSize, Baudrate);
+    const std::size_t frameSize = protocol::MaxPayloadSize + protocol::FrameOverhead;
+    // latency depends on frame on the line when command comes, so it is averaged
+    const int Samples = 16;
+    for (const std::size_t frames : {0, 1, 2, 4})
+    {
+        u64 latency = 0;
+        for (int i = 0; i < Samples; ++i)
+        {
+            latency += sharedLinkCommandLatency(frames * frameSize, 500000 + i * 37000);
+        }
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%8.1f ms",
+                      static_cast<double>(latency) / Samples / 1000);
+        benchmark::report(frames == 0 ? std::string("unlimited burst")
+                                      : "burst of " + std::to_string(frames) + " frames",
+                          buffer);
+    }
+}
+
+BENCHMARK(PacketHandlerCreditFlowControl)
+{
+    std::printf("    4 packets of %zuB to MCU with 1024B buffer consuming 2000 B/s, window 8, "
+                "%u baud\n",
+                PacketSize, Baudrate);
+    for (const bool credit : {false, true})
+    {
+        const auto result = slowConsumer(credit);
+        char buffer[128];
+        std::snprintf(buffer, sizeof(buffer),
+                      "%6llu B consumed, %6llu B lost, %6llu B sent, %3u stalls, %5.1f s",
+                      static_cast<unsigned long long>(result.bytesConsumed),
+                      static_cast<unsigned long long>(result.bytesLost),
+                      static_cast<unsigned long long>(result.bytesSent), result.stalls,
+                      static_cast<double>(result.duration) / 1000000);
+        benchmark::report(credit ? "credit flow control" : "no flow control", buffer);
+    }
+}
+
+BENCHMARK(PacketHandlerSend)
+{
+    for (const std::size_t size : {PacketSize, protocol::MaxPacketSize})
+    {
+        const DataBuffer copied(size, 0x55);
+        const auto shared = std::make_shared<const DataBuffer>(size, 0x55);
+        const auto prefix = std::to_string(size) + "B packet ";
+        benchmark::report(prefix + "copied into frames", sendSpeed(copied, size));
+        benchmark::report(prefix + "sliced from shared buffer", sendSpeed(shared, size));
+    }
+}
+
+// noisy UART damages bytes instead of losing whole frames, receiver answers with NACK
+BENCHMARK(PacketHandlerGoodputOnNoisyLine)
+{
+    printConditions();
+    for (const double corruptionRate : {0.01, 0.05})
+    {
+        for (const u8 windowSize : {1, 4, 16})
+        {
+            benchmark::report("corruption " +
+                                  std::to_string(static_cast<int>(corruptionRate * 100)) +
+                                  "% window " + std::to_string(windowSize),
+                              describe(transfer(windowSize, 0, corruptionRate)));
+        }
+    }
+}
+
+// every data frame is confirmed with 8 byte frame on reverse channel without delayed acks
+BENCHMARK(PacketHandlerDelayedAck)
+{
+    printConditions();
+    for (const double lossRate : {0.0, 0.05})
+    {
+        for (const u8 ackFrames : {0, 4, 8})
+        {
+            const auto result = transfer(16, lossRate, 0, ackFrames);
+            char buffer[48];
+            std::snprintf(buffer, sizeof(buffer), "%6llu B of acks, ",
+                          static_cast<unsigned long long>(result.bytesSentBack));
+            benchmark::report("loss " + std::to_string(static_cast<int>(lossRate * 100)) +
+                                  "% window 16 " +
+                                  (ackFrames == 0 ? std::string("ack per frame")
+                                                  : "ack per " + std::to_string(ackFrames) +
+                                                        " frames"),
+                              buffer + describe(result));
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "helper/benchmark.hpp"
+#include "stub/simulatedClock.hpp"
+#include "timer/manager.hpp"
+#include "timer/wheelManager.hpp"
+
+namespace
+{
+
+const std::size_t TimerCounts[] = {10, 1000, 100000};
+// retransmission like timeouts, most of them are cancelled before they expire
+const u32 MinTimeout = 1;
+const u32 MaxTimeout = 60000;
+const u64 Ticks = 1000;
+const std::size_t TimersPerMeasurement = 100000;
+// simulated time is kept in microseconds
+const u64 Tick = 1000;
+
+u64 elapsedNanoseconds(const std::chrono::steady_clock::time_point start)
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+}
+
+template <typename Manager>
+double setAndCancel(const std::size_t timers)
+{
+    stub::time::setCurrentTime(0);
+    Manager timerManager;
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<u32> timeout(MinTimeout, MaxTimeout);
+    std::vector<timer::ITimer::TimerPtr> handles;
+    handles.reserve(timers);
+
+    const std::size_t rounds = TimersPerMeasurement / timers;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+        for (std::size_t i = 0; i < timers; ++i)
+        {
+            handles.push_back(timerManager.setTimeout(timeout(random), []() {}));
+        }
+        for (const auto& handle : handles)
+        {
+            handle->cancel();
+        }
+        handles.clear();
+        // vector manager forgets cancelled timers only on run
+        timerManager.run();
+    }
+    return static_cast<double>(elapsedNanoseconds(start)) / (rounds * timers);
+}
+
+template <typename Manager>
+double armAndCancel(const std::size_t timers)
+{
+    stub::time::setCurrentTime(0);
+    Manager timerManager;
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<u32> timeout(MinTimeout, MaxTimeout);
+    std::vector<timer::Handle> handles(timers);
+
+    const std::size_t rounds = TimersPerMeasurement / timers;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+        for (auto& handle : handles)
+        {
+            handle = timerManager.arm(timeout(random), []() {});
+        }
+        for (auto& handle : handles)
+        {
+            timerManager.cancel(handle);
+        }
+        timerManager.run();
+    }
+    return static_cast<double>(elapsedNanoseconds(start)) / (rounds * timers);
+}
+
+// Every expired timer is armed again, so number of pending timers stays the same
+template <typename Manager>
+double tick(const std::size_t timers, u64& fired)
+{
+    stub::time::setCurrentTime(0);
+    Manager timerManager;
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<u32> timeout(MinTimeout, MaxTimeout);
+    std::function<void()> rearm = [&timerManager, &random, &timeout, &fired, &rearm]() {
+        ++fired;
+        timerManager.setTimeout(timeout(random), rearm);
+    };
+    for (std::size_t i = 0; i < timers; ++i)
+    {
+        timerManager.setTimeout(timeout(random), rearm);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (u64 i = 0; i < Ticks; ++i)
+    {
+        stub::time::forwardTime(Tick);
+        timerManager.run();
+    }
+    return static_cast<double>(elapsedNanoseconds(start)) / Ticks;
+}
+
+std::string nanoseconds(const double value, const char* unit)
+{
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%12.1f ns/%s", value, unit);
+    return buffer;
+}
+
+} // namespace
+
+BENCHMARK(TimerManagerSetAndCancel)
+{
+    for (const auto timers : TimerCounts)
+    {
+        const auto prefix = std::to_string(timers) + " timers ";
+        benchmark::report(prefix + "vector", nanoseconds(setAndCancel<timer::Manager>(timers),
+                                                         "timer"));
+        benchmark::report(prefix + "wheel", nanoseconds(setAndCancel<timer::WheelManager>(timers),
+                                                        "timer"));
+        benchmark::report(prefix + "vector handle",
+                          nanoseconds(armAndCancel<timer::Manager>(timers), "timer"));
+        benchmark::report(prefix + "wheel handle",
+                          nanoseconds(armAndCancel<timer::WheelManager>(timers), "timer"));
+    }
+}
+
+BENCHMARK(TimerManagerRun)
+{
+    for (const auto timers : TimerCounts)
+    {
+        const auto prefix = std::to_string(timers) + " timers ";
+        u64 vectorFired = 0;
+        u64 wheelFired = 0;
+        benchmark::report(prefix + "vector",
+                          nanoseconds(tick<timer::Manager>(timers, vectorFired), "run"));
+        benchmark::report(prefix + "wheel",
+                          nanoseconds(tick<timer::WheelManager>(timers, wheelFired), "run"));
+        benchmark::report(prefix + "fired", std::to_string(vectorFired) + " vector, " +
+                                                std::to_string(wheelFired) + " wheel");
+    }
+}
@@ -0,0 +1,12 @@
+#include <cstdio>
+#include <string>
+
+#include "helper/benchmark.hpp"
+
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+    const int executed = benchmark::run(filter);
+    std::printf("%d benchmarks executed\n", executed);
+    return executed > 0 ? 0 : 1;
+}
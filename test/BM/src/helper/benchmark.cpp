@@ -0,0 +1,62 @@
+#include "helper/benchmark.hpp"
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace benchmark
+{
+
+namespace
+{
+
+std::vector<std::pair<std::string, BenchmarkFunction>>& registry()
+{
+    static std::vector<std::pair<std::string, BenchmarkFunction>> benchmarks;
+    return benchmarks;
+}
+
+} // namespace
+
+bool add(const std::string& name, BenchmarkFunction function)
+{
+    registry().emplace_back(name, function);
+    return true;
+}
+
+int run(const std::string& filter)
+{
+    int executed = 0;
+    for (const auto& benchmark : registry())
+    {
+        if (!filter.empty() && benchmark.first.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        std::printf("[ RUN      ] %s\n", benchmark.first.c_str());
+        benchmark.second();
+        std::printf("[     DONE ] %s\n", benchmark.first.c_str());
+        ++executed;
+    }
+    return executed;
+}
+
+u64 cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+void report(const std::string& name, const std::string& value)
+{
+    std::printf("    %-48s %s\n", name.c_str(), value.c_str());
+}
+
+} // namespace benchmark
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "utils/types.hpp"
+
+namespace benchmark
+{
+
+using BenchmarkFunction = void (*)();
+
+bool add(const std::string& name, BenchmarkFunction function);
+int run(const std::string& filter);
+
+u64 cycles();
+
+struct Measurement
+{
+    u64 cycles;
+    u64 nanoseconds;
+    u64 iterations;
+};
+
+template <typename Function>
+Measurement measure(const u64 iterations, Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const u64 startCycles = cycles();
+    for (u64 i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    const u64 stopCycles = cycles();
+    const auto stop = std::chrono::steady_clock::now();
+    return Measurement{
+        stopCycles - startCycles,
+        static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()),
+        iterations};
+}
+
+template <typename T>
+void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void report(const std::string& name, const std::string& value);
+
+} // namespace benchmark
+
+#define BENCHMARK(name)                                                      \
+    static void name();                                                      \
+    static const bool name##Registered = benchmark::add(#name, &name);       \
+    static void name()
@@ -0,0 +1,126 @@
+#include "helper/simulatedLink.hpp"
+
+#include <algorithm>
+
+#include "stub/simulatedClock.hpp"
+
+namespace helper
+{
+
+namespace
+{
+// start bit, 8 data bits and stop bit
+const u64 BitsPerByte = 10;
+const u64 MicrosecondsInSecond = 1000000;
+} // namespace
+
+SimulatedLink::SimulatedLink(const Parameters& parameters)
+    : parameters_(parameters), random_(parameters.seed), loss_(parameters.lossRate),
+      corruption_(parameters.corruptionRate), first_(std::make_shared<Endpoint>(*this)),
+      second_(std::make_shared<Endpoint>(*this)), bytesSent_(0), writesLost_(0),
+      writesCorrupted_(0)
+{
+    first_->peer = second_;
+    second_->peer = first_;
+}
+
+dispatcher::IDataReceiver::RawDataReceiverPtr SimulatedLink::first() const
+{
+    return first_;
+}
+
+dispatcher::IDataReceiver::RawDataReceiverPtr SimulatedLink::second() const
+{
+    return second_;
+}
+
+void SimulatedLink::run()
+{
+    first_->deliver();
+    second_->deliver();
+}
+
+u64 SimulatedLink::bytesSent() const
+{
+    return bytesSent_;
+}
+
+u64 SimulatedLink::bytesSentBack() const
+{
+    return second_->bytesSent;
+}
+
+u64 SimulatedLink::writesLost() const
+{
+    return writesLost_;
+}
+
+u64 SimulatedLink::writesCorrupted() const
+{
+    return writesCorrupted_;
+}
+
+void SimulatedLink::transmit(Endpoint& from, const BufferSpan& data)
+{
+    const u64 start = std::max(stub::time::microseconds(), from.busyUntil);
+    from.busyUntil =
+        start + data.size() * BitsPerByte * MicrosecondsInSecond / parameters_.baudrate;
+    bytesSent_ += data.size();
+    from.bytesSent += data.size();
+
+    // lost data still occupies the line
+    if (loss_(random_))
+    {
+        ++writesLost_;
+        return;
+    }
+    Chunk chunk{from.busyUntil + parameters_.latency, DataBuffer(data.begin(), data.end())};
+    if (corruption_(random_))
+    {
+        ++writesCorrupted_;
+        std::uniform_int_distribution<std::size_t> position(0, chunk.data.size() - 1);
+        std::uniform_int_distribution<int> bits(1, 255);
+        chunk.data[position(random_)] ^= static_cast<u8>(bits(random_));
+    }
+    from.peer->inFlight.push_back(std::move(chunk));
+}
+
+SimulatedLink::Endpoint::Endpoint(SimulatedLink& link) : busyUntil(0), bytesSent(0), link_(link)
+{
+}
+
+void SimulatedLink::Endpoint::setHandler(const ReaderCallback& callback)
+{
+    readerCallback = callback;
+}
+
+void SimulatedLink::Endpoint::write(const std::string& data)
+{
+    link_.transmit(*this, BufferSpan{reinterpret_cast<const u8*>(data.data()), // NOLINT
+                                     static_cast<BufferIndexType>(data.size())});
+}
+
+void SimulatedLink::Endpoint::write(const BufferSpan& buffer)
+{
+    link_.transmit(*this, buffer);
+}
+
+void SimulatedLink::Endpoint::write(const u8 byte)
+{
+    link_.transmit(*this, BufferSpan{&byte, 1});
+}
+
+void SimulatedLink::Endpoint::deliver()
+{
+    while (!inFlight.empty() && inFlight.front().deliveryTime <= stub::time::microseconds())
+    {
+        const Chunk chunk = std::move(inFlight.front());
+        inFlight.pop_front();
+        if (readerCallback)
+        {
+            readerCallback(chunk.data, defaultWriter);
+        }
+    }
+}
+
+} // namespace helper
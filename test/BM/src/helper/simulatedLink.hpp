@@ -0,0 +1,95 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <random>
+
+#include "dispatcher/IDataReceiver.hpp"
+#include "utils/types.hpp"
+
+namespace helper
+{
+
+/* Full duplex serial line between two endpoints driven by stub::time.
+ * Every write is serialized at given baudrate, delayed by latency, dropped with lossRate and
+ * has one of its bytes damaged with corruptionRate.
+ */
+class SimulatedLink
+{
+public:
+    struct Parameters
+    {
+        u32 baudrate;
+        u32 latency; // microseconds
+        double lossRate;
+        double corruptionRate;
+        u32 seed;
+    };
+
+    explicit SimulatedLink(const Parameters& parameters);
+    SimulatedLink(const SimulatedLink&) = delete;
+    SimulatedLink(const SimulatedLink&&) = delete;
+    SimulatedLink& operator=(const SimulatedLink&&) = delete;
+    SimulatedLink& operator=(const SimulatedLink&) = delete;
+    ~SimulatedLink() = default;
+
+    dispatcher::IDataReceiver::RawDataReceiverPtr first() const;
+    dispatcher::IDataReceiver::RawDataReceiverPtr second() const;
+
+    // delivers data which reached other side until current simulated time
+    void run();
+
+    u64 bytesSent() const;
+    // sent from second endpoint to first one, e.g. acks of transfer from first
+    u64 bytesSentBack() const;
+    u64 writesLost() const;
+    u64 writesCorrupted() const;
+
+private:
+    struct Chunk
+    {
+        u64 deliveryTime;
+        DataBuffer data;
+    };
+
+    class Endpoint : public dispatcher::IDataReceiver
+    {
+    public:
+        explicit Endpoint(SimulatedLink& link);
+        Endpoint(const Endpoint&) = delete;
+        Endpoint(const Endpoint&&) = delete;
+        Endpoint& operator=(const Endpoint&&) = delete;
+        Endpoint& operator=(const Endpoint&) = delete;
+        ~Endpoint() = default;
+
+        void setHandler(const ReaderCallback& readerCallback) override;
+        void write(const std::string& data) override;
+        void write(const BufferSpan& buffer) override;
+        void write(u8 byte) override;
+
+        void deliver();
+
+        std::shared_ptr<Endpoint> peer;
+        ReaderCallback readerCallback;
+        std::deque<Chunk> inFlight;
+        u64 busyUntil;
+        u64 bytesSent;
+
+    private:
+        SimulatedLink& link_;
+    };
+
+    void transmit(Endpoint& from, const BufferSpan& data);
+
+    Parameters parameters_;
+    std::mt19937 random_;
+    std::bernoulli_distribution loss_;
+    std::bernoulli_distribution corruption_;
+    std::shared_ptr<Endpoint> first_;
+    std::shared_ptr<Endpoint> second_;
+    u64 bytesSent_;
+    u64 writesLost_;
+    u64 writesCorrupted_;
+};
+
+} // namespace helper
@@ -0,0 +1,30 @@
+#include "stub/simulatedClock.hpp"
+
+#include "hal/time/time.hpp"
+
+namespace stub
+{
+namespace time
+{
+
+static u64 currentTime = 0;
+
+void setCurrentTime(u64 microseconds)
+{
+    currentTime = microseconds;
+    hal::time::setClock(&stub::time::microseconds);
+}
+
+void forwardTime(u64 microseconds)
+{
+    currentTime += microseconds;
+    hal::time::tick();
+}
+
+u64 microseconds()
+{
+    return currentTime;
+}
+
+} // namespace time
+} // namespace stub
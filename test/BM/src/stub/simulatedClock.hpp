@@ -0,0 +1,17 @@
+#pragma once
+
+#include "utils/types.hpp"
+
+namespace stub
+{
+namespace time
+{
+
+// Clock source of hal::time in benchmarks, simulated protocol runs don't wait for real time.
+// setCurrentTime installs it, time moved forward is seen by hal::time::now() at once.
+void setCurrentTime(u64 microseconds);
+void forwardTime(u64 microseconds);
+u64 microseconds();
+
+} // namespace time
+} // namespace stub
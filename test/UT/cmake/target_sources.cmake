@@ -11,4 +11,5 @@ set(target_srcs
     ${X86_SRC_DIR}/net/socket/websocket_x86.cpp
     ${X86_SRC_DIR}/serial/serialPort_x86.cpp
     ${X86_SRC_DIR}/time/sleep_x86.cpp
+    ${X86_SRC_DIR}/time/time_x86.cpp
 )
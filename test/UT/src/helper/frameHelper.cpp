@@ -2,6 +2,8 @@
 
 #include <cassert>
 
+#include <CRC.h>
+
 #include "protocol/frame.hpp"
 #include "protocol/messages/control.hpp"
 #include "serializer/serializer.hpp"
@@ -91,4 +93,17 @@ DataBuffer createCrc32Frame(const u8 port, const u8 frameNumber, const DataBuffe
     crcFrame.push_back(protocol::FrameByte::End);
     return crcFrame;
 }
+
+DataBuffer createControlFrame(const u8 port, const u8 frameNumber, const u8 control,
+                              const DataBuffer& payload)
+{
+    DataBuffer frame = {protocol::FrameByte::Start, static_cast<u8>(payload.size()), frameNumber,
+                        port, control};
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    frame.resize(frame.size() + 2);
+    serializer::serialize(frame.data() + frame.size() - 2,
+                          CRC::Calculate(payload.data(), payload.size(), CRC::CRC_16_ARC()));
+    frame.push_back(protocol::FrameByte::End);
+    return frame;
+}
 } // namespace helper
\ No newline at end of file
@@ -15,4 +15,7 @@ DataBuffer createAck(const u8 port, const u8 frameNumber);
 
 DataBuffer createCrc32Frame(const u8 port, const u8 frameNumber, const DataBuffer& data);
 
+DataBuffer createControlFrame(const u8 port, const u8 frameNumber, const u8 control,
+                              const DataBuffer& payload);
+
 } // namespace helper
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "stub/allocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+u64 allocations = 0;
+
+void* allocate(std::size_t size)
+{
+    ++allocations;
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+namespace stub
+{
+namespace allocation
+{
+
+u64 count()
+{
+    return allocations;
+}
+
+} // namespace allocation
+} // namespace stub
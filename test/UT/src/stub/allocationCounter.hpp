@@ -0,0 +1,14 @@
+#pragma once
+
+#include "utils/types.hpp"
+
+namespace stub
+{
+namespace allocation
+{
+
+// Number of global operator new calls since start of test binary
+u64 count();
+
+} // namespace allocation
+} // namespace stub
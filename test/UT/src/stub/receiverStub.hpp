@@ -8,7 +8,7 @@ namespace stub
 {
 struct ReceiverStub : public dispatcher::IDataReceiver
 {
-    ReceiverStub() : logger("Receiver stub")
+    ReceiverStub() : writeCalls(0), logger("Receiver stub")
     {
     }
     ReceiverStub(const ReceiverStub&) = delete;
@@ -23,6 +23,7 @@ struct ReceiverStub : public dispatcher::IDataReceiver
 
     void write(const std::string& data) override
     {
+        ++writeCalls;
         writeBuffer.resize(writeBuffer.size() + data.length());
         memcpy(writeBuffer.data() + writeBuffer.size() - data.length(), data.c_str(),
                data.length());
@@ -30,23 +31,27 @@ struct ReceiverStub : public dispatcher::IDataReceiver
 
     void write(const BufferSpan& buffer) override
     {
+        ++writeCalls;
         writeBuffer.resize(writeBuffer.size() + buffer.size());
         memcpy(writeBuffer.data() + writeBuffer.size() - buffer.size(), buffer.data(), buffer.size());
     }
 
     void write(const u8 byte) override
     {
+        ++writeCalls;
         writeBuffer.push_back(byte);
     }
 
     void clearBuffers()
     {
         writeBuffer.clear();
+        writeCalls = 0;
     }
 
     ReaderCallback readerCallback;
 
     DataBuffer writeBuffer;
+    std::size_t writeCalls;
     logger::Logger logger;
 };
 } // namespace stub
@@ -1,35 +1,31 @@
+#include "stub/timeStub.hpp"
+
 #include "hal/time/time.hpp"
 
-namespace hal
+namespace stub
 {
 namespace time
 {
-
-static u64 currentTime = 0;
-
-
-u64 milliseconds()
+namespace
 {
-    return currentTime;
-}
+u64 currentTime = 0;
 
-} // namespace time
-} // namespace hal
-
-
-namespace stub
-{
-namespace time
+u64 microseconds()
 {
+    return currentTime * 1000;
+}
+} // namespace
 
 void setCurrentTime(u64 milliseconds)
 {
-    hal::time::currentTime = milliseconds;
+    currentTime = milliseconds;
+    hal::time::setClock(&microseconds);
 }
 
 void forwardTime(u64 milliseconds)
 {
-    hal::time::currentTime += milliseconds;
+    currentTime += milliseconds;
+    hal::time::tick();
 }
 
 } // namespace time
@@ -1,20 +1,14 @@
 #pragma once
 
-namespace hal
-{
-namespace time
-{
-
-static u64 currentTime;
-
-} // namespace time
-} // namespace hal
+#include "utils/types.hpp"
 
 namespace stub
 {
 namespace time
 {
 
+// Clock source of hal::time in tests, installed by setCurrentTime. Changes are seen by
+// hal::time::now() at once.
 void setCurrentTime(u64 milliseconds);
 void forwardTime(u64 milliseconds);
 
@@ -0,0 +1,21 @@
+#include <gtest/gtest.h>
+
+#include "container/buffer.hpp"
+
+namespace container
+{
+
+TEST(BufferShould, KeepOldestBytesWhenFull)
+{
+    Buffer<4> buffer;
+    const u8 data[] = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(4, buffer.write(gsl::span<const u8>(data)));
+    EXPECT_FALSE(buffer.write(static_cast<u8>(7)));
+
+    EXPECT_EQ(4, buffer.size());
+    EXPECT_EQ(1, buffer.getByte());
+    EXPECT_EQ(2, buffer.getByte());
+    EXPECT_TRUE(buffer.write(static_cast<u8>(7)));
+}
+
+} // namespace container
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "container/mpscQueue.hpp"
+
+namespace container
+{
+
+TEST(MpscQueueShould, PopValuesInOrderOfPush)
+{
+    MpscQueue<int> queue(4);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_TRUE(queue.push(3));
+    EXPECT_EQ(3, queue.size());
+
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(3, value);
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_EQ(0, queue.size());
+}
+
+TEST(MpscQueueShould, RejectPushWhenFullUntilValueIsPopped)
+{
+    MpscQueue<int> queue(3);
+    EXPECT_EQ(4, queue.capacity());
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(queue.push(int(i)));
+    }
+    EXPECT_FALSE(queue.push(4));
+
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(0, value);
+    EXPECT_TRUE(queue.push(4));
+    for (int i = 1; i < 5; ++i)
+    {
+        EXPECT_TRUE(queue.pop(value));
+        EXPECT_EQ(i, value);
+    }
+}
+
+TEST(MpscQueueShould, MoveValuesThroughQueue)
+{
+    MpscQueue<std::unique_ptr<int>> queue(2);
+    EXPECT_TRUE(queue.push(std::unique_ptr<int>(new int(7))));
+
+    std::unique_ptr<int> value;
+    EXPECT_TRUE(queue.pop(value));
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(7, *value);
+}
+
+TEST(MpscQueueShould, DeliverEveryValueFromConcurrentProducersInTheirOrder)
+{
+    const int Producers = 4;
+    const int ValuesPerProducer = 20000;
+    MpscQueue<int> queue(64);
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < Producers; ++producer)
+    {
+        producers.emplace_back([&queue, producer]() {
+            for (int i = 0; i < ValuesPerProducer; ++i)
+            {
+                // small queue, so producers keep running into full one
+                while (!queue.push(producer * ValuesPerProducer + i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(Producers, 0);
+    int received = 0;
+    int value = 0;
+    while (received < Producers * ValuesPerProducer)
+    {
+        if (!queue.pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        const int producer = value / ValuesPerProducer;
+        ASSERT_EQ(next[producer], value % ValuesPerProducer);
+        ++next[producer];
+        ++received;
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    EXPECT_FALSE(queue.pop(value));
+}
+
+} // namespace container
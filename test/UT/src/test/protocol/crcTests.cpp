@@ -0,0 +1,119 @@
+#include "protocol/crc.hpp"
+
+#include <gtest/gtest.h>
+
+#include <CRC.h>
+
+namespace protocol
+{
+namespace crc
+{
+
+namespace
+{
+
+DataBuffer createPayload(std::size_t size)
+{
+    DataBuffer payload(size);
+    u32 seed = 0x12345678;
+    for (auto& byte : payload)
+    {
+        seed = seed * 1103515245 + 12345;
+        byte = static_cast<u8>(seed >> 16);
+    }
+    return payload;
+}
+
+const std::size_t testedSizes[] = {0, 1, 2, 7, 8, 9, 15, 16, 63, 64, 65, 247, 255, 1000, 4096};
+
+} // namespace
+
+TEST(CrcShould, CalculateCheckValues)
+{
+    const u8 check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    EXPECT_EQ(0xbb3d, Crc16Arc::calculate(check));
+    EXPECT_EQ(0xcbf43926, Crc32::calculate(check));
+}
+
+TEST(CrcShould, MatchCrcppForCrc16Arc)
+{
+    for (const auto size : testedSizes)
+    {
+        const auto payload = createPayload(size);
+        EXPECT_EQ(CRC::Calculate(payload.data(), payload.size(), CRC::CRC_16_ARC()),
+                  Crc16Arc::calculate(payload))
+            << "size: " << size;
+    }
+}
+
+TEST(CrcShould, MatchCrcppForCrc32)
+{
+    for (const auto size : testedSizes)
+    {
+        const auto payload = createPayload(size);
+        EXPECT_EQ(CRC::Calculate(payload.data(), payload.size(), CRC::CRC_32()),
+                  Crc32::calculate(payload))
+            << "size: " << size;
+    }
+}
+
+TEST(CrcShould, MatchCrcppWithoutSlicingAndAcceleration)
+{
+    using Crc32Bytewise = ReflectedCrc<u32, 0xedb88320, 0xffffffff, 0xffffffff, NoAccelerator, 1>;
+    using Crc32Sliced = ReflectedCrc<u32, 0xedb88320, 0xffffffff, 0xffffffff, NoAccelerator, 8>;
+
+    for (const auto size : testedSizes)
+    {
+        const auto payload = createPayload(size);
+        const auto expected = CRC::Calculate(payload.data(), payload.size(), CRC::CRC_32());
+        EXPECT_EQ(expected, Crc32Bytewise::calculate(payload)) << "size: " << size;
+        EXPECT_EQ(expected, Crc32Sliced::calculate(payload)) << "size: " << size;
+    }
+}
+
+TEST(CrcShould, UpdateIncrementally)
+{
+    const auto payload = createPayload(4096);
+    const BufferSpan data(payload);
+
+    for (const auto chunk : {1, 3, 8, 17, 64, 100, 247})
+    {
+        Crc16Arc crc16;
+        Crc32 crc32;
+        for (BufferIndexType offset = 0; offset < data.size(); offset += chunk)
+        {
+            const auto length = std::min<BufferIndexType>(chunk, data.size() - offset);
+            crc16.update(data.subspan(offset, length));
+            crc32.update(data.subspan(offset, length));
+        }
+
+        EXPECT_EQ(Crc16Arc::calculate(data), crc16.value()) << "chunk: " << chunk;
+        EXPECT_EQ(Crc32::calculate(data), crc32.value()) << "chunk: " << chunk;
+    }
+}
+
+TEST(CrcShould, UpdateByteByByte)
+{
+    const auto payload = createPayload(300);
+    Crc32 crc;
+    for (const auto byte : payload)
+    {
+        crc.update(byte);
+    }
+    EXPECT_EQ(Crc32::calculate(payload), crc.value());
+}
+
+TEST(CrcShould, Reset)
+{
+    const auto payload = createPayload(100);
+    Crc16Arc crc;
+    crc.update(payload);
+    crc.reset();
+    EXPECT_EQ(0, crc.value());
+    crc.update(payload);
+    EXPECT_EQ(Crc16Arc::calculate(payload), crc.value());
+}
+
+} // namespace crc
+} // namespace protocol
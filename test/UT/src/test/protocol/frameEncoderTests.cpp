@@ -0,0 +1,103 @@
+#include "protocol/frameEncoder.hpp"
+
+#include <gtest/gtest.h>
+
+#include <CRC.h>
+
+#include "serializer/serializer.hpp"
+
+#include "matcher/arrayCompare.hpp"
+
+namespace protocol
+{
+
+TEST(FrameEncoderShould, EncodeFrame)
+{
+    const u8 payload[] = {0x12, 0xaa, 0x11};
+    const u8 port = 10;
+    const u8 frameNumber = 7;
+    Frame<10> frame(port, frameNumber);
+    frame.control(messages::Control::Transmission);
+    frame.payload(payload, sizeof(payload));
+
+    u8 crc[2];
+    serializer::serialize(crc, CRC::Calculate(payload, sizeof(payload), CRC::CRC_16_ARC()));
+    const u8 expectedFrame[] = {FrameByte::Start, sizeof(payload), frameNumber, port,
+                                messages::Control::Transmission,
+                                payload[0],       payload[1],      payload[2],  crc[0],
+                                crc[1],           FrameByte::End};
+
+    std::array<u8, 32> buffer{};
+    EXPECT_EQ(sizeof(expectedFrame), encode(frame, buffer));
+    EXPECT_THAT(buffer.data(), ArrayCompare(expectedFrame, sizeof(expectedFrame)));
+}
+
+TEST(FrameEncoderShould, EncodeOnlyUsedPartOfPayload)
+{
+    Frame<> frame(1, 2);
+    const u8 payload[] = {0x01, 0x02};
+    frame.payload(payload, sizeof(payload));
+
+    std::array<u8, MaxPayloadSize + FrameOverhead> buffer{};
+    EXPECT_EQ(FrameOverhead + sizeof(payload), encode(frame, buffer));
+}
+
+TEST(FrameEncoderShould, RejectTooSmallBuffer)
+{
+    Frame<4> frame;
+    const u8 payload[] = {1, 2, 3, 4};
+    frame.payload(payload, sizeof(payload));
+
+    std::array<u8, FrameOverhead + 3> buffer{};
+    EXPECT_EQ(0, encode(frame, buffer));
+}
+
+TEST(FrameEncoderShould, EncodeExtendedFrame)
+{
+    Frame<300> frame(3, 4);
+    frame.control(messages::Control::Transmission);
+    DataBuffer payload(300);
+    for (std::size_t i = 0; i < payload.size(); ++i)
+    {
+        payload[i] = static_cast<u8>(i);
+    }
+    frame.payload(payload.data(), static_cast<u16>(payload.size()));
+
+    std::array<u8, 300 + ExtendedFrameOverhead> buffer{};
+    ASSERT_EQ(buffer.size(), encode(frame, buffer, true));
+
+    const u8 expectedHeader[] = {FrameByte::Start, 300 & 0xff, 4, 3,
+                                 messages::Control::Transmission | ExtendedLengthFlag, 300 >> 8};
+    EXPECT_THAT(buffer.data(), ArrayCompare(expectedHeader, sizeof(expectedHeader)));
+    EXPECT_THAT(&buffer[ExtendedFrameHeaderSize], ArrayCompare(payload.data(), payload.size()));
+    u16 crc;
+    serializer::deserialize(&buffer[ExtendedFrameHeaderSize + 300], crc);
+    EXPECT_EQ(CRC::Calculate(payload.data(), payload.size(), CRC::CRC_16_ARC()), crc);
+    EXPECT_EQ(FrameByte::End, buffer.back());
+}
+
+TEST(FrameEncoderShould, RejectLongPayloadInBasicFormat)
+{
+    Frame<300> frame;
+    const DataBuffer payload(256, 0x11);
+    frame.payload(payload.data(), static_cast<u16>(payload.size()));
+
+    std::array<u8, 300 + ExtendedFrameOverhead> buffer{};
+    EXPECT_EQ(0, encode(frame, buffer));
+}
+
+TEST(FrameEncoderShould, EncodeReplyLikeEmptyFrame)
+{
+    const u8 port = 4;
+    const u8 frameNumber = 200;
+    Frame<0> frame(port, frameNumber);
+    frame.control(messages::Control::CrcChecksumFailed);
+
+    std::array<u8, FrameOverhead> expected{};
+    encode(frame, expected);
+
+    const auto reply = encodeReply(messages::Control::CrcChecksumFailed, port, frameNumber);
+    EXPECT_THAT(reply.data(), ArrayCompare(expected.data(), expected.size()));
+}
+
+} // namespace protocol
@@ -2,15 +2,21 @@
 
 #include <gtest/gtest.h>
 
+#include <CRC.h>
+
+#include "protocol/stuffer.hpp"
 #include "serializer/serializer.hpp"
+#include "timer/manager.hpp"
 
+#include "helper/frameHelper.hpp"
 #include "matcher/arrayCompare.hpp"
 #include "stub/receiverStub.hpp"
+#include "stub/timeStub.hpp"
 
 namespace protocol
 {
 
-const auto emptyFrameReceiver = [](const IFrame& frame) {};
+const auto emptyFrameReceiver = [](const FrameView&) {};
 
 class FrameHandlerShould : public ::testing::Test
 {
@@ -59,6 +65,210 @@ TEST_F(FrameHandlerShould, Success)
                 ArrayCompare(expectedNackFrame, sizeof(expectedNackFrame)));
 }
 
+TEST_F(FrameHandlerShould, ReceiveFrameSplitBetweenReads)
+{
+    const u8 payload[] = {0x12, 0xaa, 0x11, 0x31, 0x00};
+    u8 frameNumber = 3;
+    const u16 testingPort = 10;
+    const u16 controlByte = messages::Control::Transmission;
+
+    u8 crc[2];
+    serializer::serialize(crc, CRC::Calculate(payload, sizeof(payload), CRC::CRC_16_ARC()));
+
+    const u8 frame[] = {FrameByte::Start, sizeof(payload), frameNumber, testingPort,
+                        controlByte,      payload[0],      payload[1],  payload[2],
+                        payload[3],       payload[4],      crc[0],      crc[1],
+                        FrameByte::End};
+
+    int receivedFrames = 0;
+    handler_.connect(testingPort, [&](const FrameView& received) {
+        ++receivedFrames;
+        EXPECT_EQ(frameNumber, received.number());
+        EXPECT_EQ(sizeof(payload), received.length());
+        EXPECT_THAT(received.payload(), ArrayCompare(payload, sizeof(payload)));
+        EXPECT_EQ(CRC::Calculate(payload, sizeof(payload), CRC::CRC_16_ARC()), received.crc());
+    });
+
+    const BufferSpan data(frame);
+    receiver_->readerCallback(data.subspan(0, 6), defaultWriter);
+    receiver_->readerCallback(data.subspan(6, 2), defaultWriter);
+    receiver_->readerCallback(data.subspan(8), defaultWriter);
+
+    EXPECT_EQ(1, receivedFrames);
+
+    const u8 expectedAckFrame[] = {FrameByte::Start,           0,   frameNumber, testingPort,
+                                   messages::Control::Success, 0x0, 0x0,         FrameByte::End};
+
+    EXPECT_THAT(receiver_->writeBuffer.data(),
+                ArrayCompare(expectedAckFrame, sizeof(expectedAckFrame)));
+}
+
+TEST_F(FrameHandlerShould, ReceiveSeveralFramesFromSingleRead)
+{
+    const u16 testingPort = 10;
+    std::vector<u8> numbers;
+    std::vector<DataBuffer> payloads;
+    handler_.connect(testingPort, [&](const FrameView& received) {
+        numbers.push_back(received.number());
+        payloads.emplace_back(received.payload(), received.payload() + received.length());
+    });
+
+    DataBuffer stream = {0x13, 0x37};
+    for (u8 number = 0; number < 4; ++number)
+    {
+        Frame<> frame(testingPort, number);
+        frame.control(messages::Control::Transmission);
+        const DataBuffer payload(number * 10, static_cast<u8>(FrameByte::Start));
+        frame.payload(payload.data(), static_cast<u16>(payload.size()));
+        DataBuffer encoded(payload.size() + FrameOverhead);
+        encode(frame, encoded);
+        stream.insert(stream.end(), encoded.begin(), encoded.end());
+    }
+    // last frame continues in next read
+    const BufferSpan data(stream);
+    receiver_->readerCallback(data.subspan(0, data.size() - 5), defaultWriter);
+    EXPECT_EQ((std::vector<u8>{0, 1, 2}), numbers);
+    receiver_->readerCallback(data.subspan(data.size() - 5), defaultWriter);
+
+    EXPECT_EQ((std::vector<u8>{0, 1, 2, 3}), numbers);
+    EXPECT_EQ(DataBuffer(30, FrameByte::Start), payloads.back());
+    EXPECT_EQ(4 * FrameOverhead, receiver_->writeBuffer.size());
+}
+
+namespace
+{
+
+DataBuffer transmissionFrame(const u16 port, const u8 number)
+{
+    Frame<> frame(port, number);
+    frame.control(messages::Control::Transmission);
+    DataBuffer encoded(FrameOverhead);
+    encode(frame, encoded);
+    return encoded;
+}
+
+DataBuffer cumulativeAck(const u16 port, const u8 base, const DataBuffer& bitmap)
+{
+    Frame<> frame(port, base);
+    frame.control(messages::Control::CumulativeAck);
+    frame.payload(bitmap.data(), static_cast<u16>(bitmap.size()));
+    DataBuffer encoded(bitmap.size() + FrameOverhead);
+    encode(frame, encoded);
+    return encoded;
+}
+
+} // namespace
+
+TEST_F(FrameHandlerShould, AckDuplicatesWithoutDeliveringThem)
+{
+    const u16 testingPort = 10;
+    std::vector<u8> numbers;
+    handler_.connect(testingPort,
+                     [&numbers](const FrameView& frame) { numbers.push_back(frame.number()); });
+
+    const auto frame = [testingPort](const u8 number) {
+        return transmissionFrame(testingPort, number);
+    };
+    // without window every copy is delivered
+    receiver_->readerCallback(frame(1), defaultWriter);
+    receiver_->readerCallback(frame(1), defaultWriter);
+    EXPECT_EQ((std::vector<u8>{1, 1}), numbers);
+
+    numbers.clear();
+    receiver_->clearBuffers();
+    handler_.setReceiveWindow(testingPort, 8);
+    for (const u8 number : {2, 3, 2, 4, 3})
+    {
+        receiver_->readerCallback(frame(number), defaultWriter);
+    }
+
+    EXPECT_EQ((std::vector<u8>{2, 3, 4}), numbers);
+    EXPECT_EQ(2, handler_.duplicatesSuppressed());
+    EXPECT_EQ(5, receiver_->writeCalls);
+    const auto ack = encodeReply(messages::Control::Success, testingPort, 3);
+    EXPECT_EQ(DataBuffer(ack.begin(), ack.end()),
+              DataBuffer(receiver_->writeBuffer.end() - ack.size(), receiver_->writeBuffer.end()));
+}
+
+TEST_F(FrameHandlerShould, ConfirmFramesTogetherAfterFrameLimit)
+{
+    stub::time::setCurrentTime(0);
+    timer::Manager timerManager;
+    const u16 testingPort = 10;
+    int receivedFrames = 0;
+    handler_.connect(testingPort, [&receivedFrames](const FrameView& /*frame*/) {
+        ++receivedFrames;
+    });
+    handler_.setDelayedAck(timerManager, 3, 50);
+
+    receiver_->readerCallback(transmissionFrame(testingPort, 1), defaultWriter);
+    receiver_->readerCallback(transmissionFrame(testingPort, 2), defaultWriter);
+    EXPECT_EQ(2, receivedFrames);
+    EXPECT_EQ(0, receiver_->writeCalls);
+
+    receiver_->readerCallback(transmissionFrame(testingPort, 3), defaultWriter);
+    EXPECT_EQ(1, receiver_->writeCalls);
+    EXPECT_EQ(cumulativeAck(testingPort, 1, {0x07}), receiver_->writeBuffer);
+}
+
+TEST_F(FrameHandlerShould, ConfirmCollectedFramesAfterDelay)
+{
+    stub::time::setCurrentTime(0);
+    timer::Manager timerManager;
+    const u16 testingPort = 10;
+    handler_.connect(testingPort, emptyFrameReceiver);
+    handler_.setDelayedAck(timerManager, 8, 50);
+
+    receiver_->readerCallback(transmissionFrame(testingPort, 5), defaultWriter);
+    stub::time::forwardTime(49);
+    timerManager.run();
+    EXPECT_EQ(0, receiver_->writeCalls);
+
+    stub::time::forwardTime(1);
+    timerManager.run();
+    EXPECT_EQ(cumulativeAck(testingPort, 5, {0x01}), receiver_->writeBuffer);
+}
+
+TEST_F(FrameHandlerShould, IncludeRetransmittedFrameInFrontOfCollectedOnes)
+{
+    stub::time::setCurrentTime(0);
+    timer::Manager timerManager;
+    const u16 testingPort = 10;
+    handler_.connect(testingPort, emptyFrameReceiver);
+    handler_.setDelayedAck(timerManager, 8, 50);
+
+    receiver_->readerCallback(transmissionFrame(testingPort, 3), defaultWriter);
+    receiver_->readerCallback(transmissionFrame(testingPort, 12), defaultWriter);
+    receiver_->readerCallback(transmissionFrame(testingPort, 1), defaultWriter);
+    handler_.flushAck(testingPort);
+
+    EXPECT_EQ(1, receiver_->writeCalls);
+    EXPECT_EQ(cumulativeAck(testingPort, 1, {0x05, 0x08}), receiver_->writeBuffer);
+}
+
+TEST_F(FrameHandlerShould, SendFrameInSingleWrite)
+{
+    const u8 payload[] = {0x12, 0xaa, 0x11};
+    const u8 frameNumber = 5;
+    const u16 testingPort = 10;
+    Frame<> frame(testingPort, frameNumber);
+    frame.control(messages::Control::Transmission);
+    frame.payload(payload, sizeof(payload));
+
+    handler_.send(frame);
+
+    u8 crc[2];
+    serializer::serialize(crc, CRC::Calculate(payload, sizeof(payload), CRC::CRC_16_ARC()));
+    const u8 expectedFrame[] = {FrameByte::Start, sizeof(payload), frameNumber, testingPort,
+                                messages::Control::Transmission,
+                                payload[0],       payload[1],      payload[2],  crc[0],
+                                crc[1],           FrameByte::End};
+
+    EXPECT_EQ(1, receiver_->writeCalls);
+    ASSERT_EQ(sizeof(expectedFrame), receiver_->writeBuffer.size());
+    EXPECT_THAT(receiver_->writeBuffer.data(), ArrayCompare(expectedFrame, sizeof(expectedFrame)));
+}
+
 TEST_F(FrameHandlerShould, NackWithPortNotConnected)
 {
     const u8 payload[] = {0x12, 0xaa};
@@ -80,6 +290,24 @@ TEST_F(FrameHandlerShould, NackWithPortNotConnected)
                 ArrayCompare(expectedNackFrame, sizeof(expectedNackFrame)));
 }
 
+TEST_F(FrameHandlerShould, NotAnswerReplies)
+{
+    u8 frameNumber = 0;
+    const u16 notConnectedPort = 10;
+    const u16 connectedPort = 11;
+
+    const u8 ack[] = {FrameByte::Start, 0, frameNumber, notConnectedPort, messages::Control::Success,
+                      0x0,              0x0, FrameByte::End};
+    receiver_->readerCallback(ack, defaultWriter);
+
+    const u8 damagedNack[] = {FrameByte::Start, 0,   frameNumber, connectedPort,
+                              messages::Control::CrcChecksumFailed, 0x1, 0x0, FrameByte::End};
+    handler_.connect(connectedPort, emptyFrameReceiver);
+    receiver_->readerCallback(damagedNack, defaultWriter);
+
+    EXPECT_EQ(0, receiver_->writeCalls);
+}
+
 TEST_F(FrameHandlerShould, NackWhenCrcCalculationFailed)
 {
     const u8 payload[] = {0x12, 0xaa};
@@ -152,6 +380,479 @@ TEST_F(FrameHandlerShould, SuccessWithEmptyPayload)
     EXPECT_THAT(receiver_->writeBuffer.data(),
                 ArrayCompare(expectedAckFrame, sizeof(expectedAckFrame)));
 }
+
+TEST_F(FrameHandlerShould, ReceiveExtendedFrame)
+{
+    const u8 frameNumber = 3;
+    const u16 testingPort = 10;
+    Frame<MaxExtendedPayloadSize> frame(testingPort, frameNumber);
+    frame.control(messages::Control::Transmission);
+    const DataBuffer payload(1000, 0x42);
+    frame.payload(payload.data(), static_cast<u16>(payload.size()));
+    DataBuffer encoded(payload.size() + ExtendedFrameOverhead);
+    encode(frame, encoded, true);
+
+    DataBuffer received;
+    handler_.connect(testingPort, [&received](const FrameView& frame) {
+        received.assign(frame.payload(), frame.payload() + frame.length());
+    });
+    handler_.setExtendedFrames(true);
+    receiver_->readerCallback(encoded, defaultWriter);
+
+    EXPECT_EQ(payload, received);
+    const auto ack = encodeReply(messages::Control::Success, testingPort, frameNumber);
+    EXPECT_THAT(receiver_->writeBuffer.data(), ArrayCompare(ack.data(), ack.size()));
+}
+
+TEST_F(FrameHandlerShould, DropExtendedFrameAboveReceiveBuffer)
+{
+    const u16 testingPort = 10;
+    Frame<300> frame(testingPort, 1);
+    frame.control(messages::Control::Transmission);
+    const DataBuffer payload(300, 0x42);
+    frame.payload(payload.data(), static_cast<u16>(payload.size()));
+    DataBuffer encoded(payload.size() + ExtendedFrameOverhead);
+    encode(frame, encoded, true);
+
+    int receivedFrames = 0;
+    handler_.connect(testingPort, [&receivedFrames](const FrameView& /*frame*/) {
+        ++receivedFrames;
+    });
+    receiver_->readerCallback(encoded, defaultWriter);
+    EXPECT_EQ(0, receivedFrames);
+    EXPECT_EQ(0, receiver_->writeBuffer.size());
+
+    // receiver finds start of next frame
+    Frame<> basic(testingPort, 2);
+    basic.control(messages::Control::Transmission);
+    basic.payload(payload.data(), 10);
+    DataBuffer encodedBasic(10 + FrameOverhead);
+    encode(basic, encodedBasic);
+    receiver_->readerCallback(encodedBasic, defaultWriter);
+    EXPECT_EQ(1, receivedFrames);
+}
+
+TEST_F(FrameHandlerShould, SendExtendedFramesWhenEnabled)
+{
+    const u16 testingPort = 10;
+    Frame<MaxExtendedPayloadSize> frame(testingPort, 1);
+    frame.control(messages::Control::Transmission);
+    const DataBuffer payload(500, 0x42);
+    frame.payload(payload.data(), static_cast<u16>(payload.size()));
+
+    handler_.send(frame);
+    EXPECT_EQ(0, receiver_->writeBuffer.size());
+
+    handler_.setExtendedFrames(true);
+    handler_.send(frame);
+    DataBuffer expected(payload.size() + ExtendedFrameOverhead);
+    encode(frame, expected, true);
+    EXPECT_EQ(expected, receiver_->writeBuffer);
+}
+
+namespace
+{
+
+DataBuffer stuffedFrame(const u16 port, const u8 number, const DataBuffer& payload)
+{
+    Frame<> frame(port, number);
+    frame.control(messages::Control::Transmission);
+    frame.payload(payload.data(), static_cast<u16>(payload.size()));
+    DataBuffer encoded(payload.size() + FrameOverhead);
+    encode(frame, encoded);
+
+    DataBuffer stuffed(maxStuffedSize(encoded.size()));
+    stuffed.resize(stuff(encoded, stuffed));
+    stuffed.push_back(Delimiter);
+    return stuffed;
+}
+
+} // namespace
+
+TEST_F(FrameHandlerShould, SendStuffedFramesWhenEnabled)
+{
+    const u16 testingPort = 10;
+    const DataBuffer payload = {0x00, 0xaa, 0x00, 0x11};
+    Frame<> frame(testingPort, 1);
+    frame.control(messages::Control::Transmission);
+    frame.payload(payload.data(), static_cast<u16>(payload.size()));
+
+    handler_.setStuffing(true);
+    handler_.send(frame);
+
+    EXPECT_EQ(stuffedFrame(testingPort, 1, payload), receiver_->writeBuffer);
+    EXPECT_EQ(1, receiver_->writeCalls);
+}
+
+TEST_F(FrameHandlerShould, ReceiveStuffedFrameAndStuffReply)
+{
+    const u16 testingPort = 10;
+    const DataBuffer payload = {0x00, 0x01, 0x00};
+    DataBuffer received;
+    handler_.connect(testingPort, [&received](const FrameView& frame) {
+        received.assign(frame.payload(), frame.payload() + frame.length());
+    });
+    handler_.setStuffing(true);
+
+    const DataBuffer stuffed = stuffedFrame(testingPort, 3, payload);
+    // delimiter in separate read
+    receiver_->readerCallback(BufferSpan{stuffed.data(), static_cast<BufferIndexType>(5)},
+                              defaultWriter);
+    receiver_->readerCallback(
+        BufferSpan{&stuffed[5], static_cast<BufferIndexType>(stuffed.size() - 5)}, defaultWriter);
+
+    EXPECT_EQ(payload, received);
+    const auto ack = encodeReply(messages::Control::Success, testingPort, 3);
+    DataBuffer expectedAck(maxStuffedSize(ack.size()));
+    expectedAck.resize(stuff(ack, expectedAck));
+    expectedAck.push_back(Delimiter);
+    EXPECT_EQ(expectedAck, receiver_->writeBuffer);
+}
+
+TEST_F(FrameHandlerShould, ResynchroniseOnNextDelimiterAfterDamagedStuffedFrame)
+{
+    const u16 testingPort = 10;
+    std::vector<u8> numbers;
+    handler_.connect(testingPort,
+                     [&numbers](const FrameView& frame) { numbers.push_back(frame.number()); });
+    handler_.setStuffing(true);
+
+    // longer frame claimed by damaged length would swallow following frames
+    DataBuffer damaged = stuffedFrame(testingPort, 1, DataBuffer(20, 0xaa));
+    damaged[2] = 0xf0;
+    DataBuffer stream = damaged;
+    for (u8 number = 2; number < 4; ++number)
+    {
+        const DataBuffer frame = stuffedFrame(testingPort, number, DataBuffer(20, 0xaa));
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    // line noise between delimiters is dropped
+    const DataBuffer noise = {0x00, 0x13, 0x37, 0x00};
+    stream.insert(stream.end(), noise.begin(), noise.end());
+    const DataBuffer last = stuffedFrame(testingPort, 4, DataBuffer(20, 0xaa));
+    stream.insert(stream.end(), last.begin(), last.end());
+
+    receiver_->readerCallback(stream, defaultWriter);
+
+    EXPECT_EQ((std::vector<u8>{2, 3, 4}), numbers);
+}
+
+TEST_F(FrameHandlerShould, DropStuffedFrameAboveReceiveBuffer)
+{
+    const u16 testingPort = 10;
+    int receivedFrames = 0;
+    handler_.connect(testingPort, [&receivedFrames](const FrameView& /*frame*/) {
+        ++receivedFrames;
+    });
+    handler_.setStuffing(true);
+
+    // missing delimiter glues frames together
+    DataBuffer stream;
+    for (u8 number = 0; number < 4; ++number)
+    {
+        DataBuffer frame = stuffedFrame(testingPort, number, DataBuffer(MaxPayloadSize, 0x42));
+        frame.pop_back();
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    stream.push_back(Delimiter);
+    const DataBuffer next = stuffedFrame(testingPort, 5, DataBuffer(8, 0x42));
+    stream.insert(stream.end(), next.begin(), next.end());
+
+    receiver_->readerCallback(stream, defaultWriter);
+    EXPECT_EQ(1, receivedFrames);
+}
+
+namespace
+{
+
+// Sends frames with given payload sizes, numbered from 0
+class TransmitSourceStub : public ITransmitSource
+{
+public:
+    TransmitSourceStub(FrameHandler& handler, const u16 port, const std::vector<u16>& sizes)
+        : handler_(handler), port_(port), sizes_(sizes), next_(0)
+    {
+    }
+
+    std::size_t nextFrameSize() override
+    {
+        return next_ < sizes_.size() ? sizes_[next_] : 0;
+    }
+
+    void sendNextFrame() override
+    {
+        const DataBuffer payload(sizes_[next_], 0x42);
+        Frame<> frame(port_, static_cast<u8>(next_++));
+        frame.control(messages::Control::Transmission);
+        frame.payload(payload.data(), static_cast<u16>(payload.size()));
+        handler_.send(frame);
+    }
+
+private:
+    FrameHandler& handler_;
+    u16 port_;
+    std::vector<u16> sizes_;
+    std::size_t next_;
+};
+
+// Port and number of every frame written to link
+std::vector<std::pair<u8, u8>> writtenFrames(const DataBuffer& buffer)
+{
+    std::vector<std::pair<u8, u8>> frames;
+    for (std::size_t i = 0; i < buffer.size(); i += buffer[i + LengthOffset] + FrameOverhead)
+    {
+        frames.emplace_back(buffer[i + PortOffset], buffer[i + NumberOffset]);
+    }
+    return frames;
+}
+
+// Port is disconnected once its first frame is sent, as when packet owner is destroyed
+class DisconnectingSourceStub : public TransmitSourceStub
+{
+public:
+    DisconnectingSourceStub(FrameHandler& handler, const u16 port, const std::vector<u16>& sizes)
+        : TransmitSourceStub(handler, port, sizes), handler_(handler), port_(port)
+    {
+    }
+
+    void sendNextFrame() override
+    {
+        TransmitSourceStub::sendNextFrame();
+        handler_.disconnect(port_);
+    }
+
+private:
+    FrameHandler& handler_;
+    u16 port_;
+};
+
+using Frames = std::vector<std::pair<u8, u8>>;
+
+const u16 firstPort = 10;
+const u16 secondPort = 11;
+// ports become ready together when frame on this port is received
+const u16 triggerPort = 1;
+
+} // namespace
+
+TEST_F(FrameHandlerShould, InterleaveFramesOfReadyPortsInRoundRobin)
+{
+    TransmitSourceStub first(handler_, firstPort, {200, 200, 200});
+    TransmitSourceStub second(handler_, secondPort, {200, 200, 200});
+    handler_.connect(firstPort, emptyFrameReceiver);
+    handler_.connect(secondPort, emptyFrameReceiver);
+    handler_.setTransmitSource(firstPort, first);
+    handler_.setTransmitSource(secondPort, second);
+    handler_.connect(triggerPort, [this](const FrameView& /*frame*/) {
+        handler_.ready(firstPort);
+        handler_.ready(secondPort);
+    });
+
+    receiver_->readerCallback(transmissionFrame(triggerPort, 0), defaultWriter);
+
+    // reply is written before frames, scheduler waits until read is parsed
+    const Frames expected{{triggerPort, 0}, {firstPort, 0}, {secondPort, 0}, {firstPort, 1},
+                          {secondPort, 1},  {firstPort, 2}, {secondPort, 2}};
+    EXPECT_EQ(expected, writtenFrames(receiver_->writeBuffer));
+}
+
+TEST_F(FrameHandlerShould, GiveWeightedPortMoreFramesPerRound)
+{
+    TransmitSourceStub first(handler_, firstPort, {200, 200, 200, 200});
+    TransmitSourceStub second(handler_, secondPort, {200, 200});
+    handler_.connect(firstPort, emptyFrameReceiver);
+    handler_.connect(secondPort, emptyFrameReceiver);
+    handler_.setTransmitSource(firstPort, first, 2);
+    handler_.setTransmitSource(secondPort, second);
+    handler_.connect(triggerPort, [this](const FrameView& /*frame*/) {
+        handler_.ready(firstPort);
+        handler_.ready(secondPort);
+    });
+
+    receiver_->readerCallback(transmissionFrame(triggerPort, 0), defaultWriter);
+
+    const Frames expected{{triggerPort, 0}, {firstPort, 0}, {firstPort, 1},
+                          {secondPort, 0},  {firstPort, 2}, {firstPort, 3},
+                          {secondPort, 1}};
+    EXPECT_EQ(expected, writtenFrames(receiver_->writeBuffer));
+}
+
+TEST_F(FrameHandlerShould, ContinueRoundAfterEachReadWhenBurstIsSpent)
+{
+    TransmitSourceStub first(handler_, firstPort, {200, 200, 200});
+    TransmitSourceStub second(handler_, secondPort, {200});
+    handler_.connect(firstPort, emptyFrameReceiver);
+    handler_.connect(secondPort, emptyFrameReceiver);
+    handler_.setTransmitSource(firstPort, first);
+    handler_.setTransmitSource(secondPort, second);
+    handler_.setTransmitBurst(1);
+
+    handler_.ready(firstPort);
+    handler_.ready(secondPort);
+    Frames expected{{firstPort, 0}};
+    EXPECT_EQ(expected, writtenFrames(receiver_->writeBuffer));
+
+    // any read, e.g. ack of the frame, starts next pass
+    const u8 noise = 0x00;
+    for (const auto& frame : Frames{{firstPort, 1}, {secondPort, 0}, {firstPort, 2}})
+    {
+        receiver_->readerCallback(BufferSpan{&noise, 1}, defaultWriter);
+        expected.push_back(frame);
+        EXPECT_EQ(expected, writtenFrames(receiver_->writeBuffer));
+    }
+}
+
+TEST_F(FrameHandlerShould, StopServingDisconnectedPort)
+{
+    TransmitSourceStub first(handler_, firstPort, {200, 200});
+    handler_.connect(firstPort, emptyFrameReceiver);
+    handler_.setTransmitSource(firstPort, first);
+    handler_.setTransmitBurst(1);
+
+    handler_.ready(firstPort);
+    handler_.disconnect(firstPort);
+    const u8 noise = 0x00;
+    receiver_->readerCallback(BufferSpan{&noise, 1}, defaultWriter);
+    EXPECT_EQ((Frames{{firstPort, 0}}), writtenFrames(receiver_->writeBuffer));
+}
+
+TEST_F(FrameHandlerShould, EndTurnOfPortDisconnectedBySentFrame)
+{
+    DisconnectingSourceStub first(handler_, firstPort, {100, 100});
+    TransmitSourceStub second(handler_, secondPort, {100});
+    handler_.connect(firstPort, emptyFrameReceiver);
+    handler_.connect(secondPort, emptyFrameReceiver);
+    handler_.setTransmitSource(firstPort, first);
+    handler_.setTransmitSource(secondPort, second);
+    handler_.connect(triggerPort, [this](const FrameView& /*frame*/) {
+        handler_.ready(firstPort);
+        handler_.ready(secondPort);
+    });
+
+    receiver_->readerCallback(transmissionFrame(triggerPort, 0), defaultWriter);
+
+    const Frames expected{{triggerPort, 0}, {firstPort, 0}, {secondPort, 0}};
+    EXPECT_EQ(expected, writtenFrames(receiver_->writeBuffer));
+}
+
+namespace
+{
+
+DataBuffer dataFrame(const u16 port, const u8 number, const std::size_t size)
+{
+    return helper::createControlFrame(static_cast<u8>(port), number,
+                                      messages::Control::Transmission, DataBuffer(size, 0x42));
+}
+
+DataBuffer credit(const u16 bytes)
+{
+    DataBuffer payload(sizeof(bytes));
+    serializer::serialize(payload.data(), bytes);
+    return payload;
+}
+
+} // namespace
+
+TEST_F(FrameHandlerShould, AdvertiseCreditInAcks)
+{
+    const u16 testingPort = 10;
+    handler_.connect(testingPort, emptyFrameReceiver);
+    handler_.setReceiveCredit(testingPort, 100);
+
+    receiver_->readerCallback(dataFrame(testingPort, 0, 30), defaultWriter);
+
+    EXPECT_EQ(70, handler_.receiveCredit(testingPort));
+    const auto expected =
+        helper::createControlFrame(testingPort, 0, messages::Control::Success, credit(70));
+    EXPECT_EQ(expected, receiver_->writeBuffer);
+}
+
+TEST_F(FrameHandlerShould, DropFrameAboveCreditWithoutAck)
+{
+    const u16 testingPort = 10;
+    int receivedFrames = 0;
+    handler_.connect(testingPort, [&receivedFrames](const FrameView& /*frame*/) {
+        ++receivedFrames;
+    });
+    handler_.setReceiveCredit(testingPort, 20);
+
+    receiver_->readerCallback(dataFrame(testingPort, 0, 30), defaultWriter);
+
+    EXPECT_EQ(0, receivedFrames);
+    EXPECT_EQ(1, handler_.creditOverruns());
+    EXPECT_EQ(20, handler_.receiveCredit(testingPort));
+    EXPECT_TRUE(receiver_->writeBuffer.empty());
+}
+
+TEST_F(FrameHandlerShould, SendCreditUpdateWhenSpentCreditIsReleased)
+{
+    const u16 testingPort = 10;
+    handler_.connect(testingPort, emptyFrameReceiver);
+    handler_.setReceiveCredit(testingPort, 600);
+    receiver_->readerCallback(dataFrame(testingPort, 0, 250), defaultWriter);
+    receiver_->readerCallback(dataFrame(testingPort, 1, 250), defaultWriter);
+    receiver_->clearBuffers();
+
+    // below longest frame peer may wait for credit
+    handler_.releaseCredit(testingPort, 200);
+    auto expected =
+        helper::createControlFrame(testingPort, 0, messages::Control::CreditUpdate, credit(300));
+    EXPECT_EQ(expected, receiver_->writeBuffer);
+
+    // peer can send, it learns about the rest from next ack
+    receiver_->clearBuffers();
+    handler_.releaseCredit(testingPort, 300);
+    EXPECT_EQ(600, handler_.receiveCredit(testingPort));
+    EXPECT_TRUE(receiver_->writeBuffer.empty());
+
+    receiver_->readerCallback(
+        helper::createControlFrame(testingPort, 0, messages::Control::CreditRequest, {}),
+        defaultWriter);
+    expected =
+        helper::createControlFrame(testingPort, 0, messages::Control::CreditUpdate, credit(600));
+    EXPECT_EQ(expected, receiver_->writeBuffer);
+}
+
+TEST_F(FrameHandlerShould, SendCreditUpdateOnceLongestFrameOfPeerFits)
+{
+    const u16 testingPort = 10;
+    handler_.connect(testingPort, emptyFrameReceiver);
+    handler_.setReceiveCredit(testingPort, 500);
+    receiver_->readerCallback(dataFrame(testingPort, 0, MaxPayloadSize), defaultWriter);
+    receiver_->readerCallback(dataFrame(testingPort, 1, MaxPayloadSize), defaultWriter);
+    receiver_->clearBuffers();
+
+    // packet frames carry 247 bytes, though basic frame could carry up to 255
+    handler_.releaseCredit(testingPort, MaxPayloadSize - 6);
+    const auto expected = helper::createControlFrame(
+        testingPort, 0, messages::Control::CreditUpdate, credit(MaxPayloadSize));
+    EXPECT_EQ(expected, receiver_->writeBuffer);
+
+    // receiving extended frames doesn't make peer send longer ones
+    handler_.setExtendedFrames(true);
+    receiver_->readerCallback(dataFrame(testingPort, 2, MaxPayloadSize), defaultWriter);
+    receiver_->clearBuffers();
+    handler_.releaseCredit(testingPort, MaxPayloadSize);
+    EXPECT_FALSE(receiver_->writeBuffer.empty());
+}
+
+TEST_F(FrameHandlerShould, CarryCreditWithCollectedAcks)
+{
+    const u16 testingPort = 10;
+    timer::Manager timerManager;
+    handler_.connect(testingPort, emptyFrameReceiver);
+    handler_.setReceiveCredit(testingPort, 100);
+    handler_.setDelayedAck(timerManager, 2, 50);
+
+    receiver_->readerCallback(dataFrame(testingPort, 4, 10), defaultWriter);
+    receiver_->readerCallback(dataFrame(testingPort, 5, 10), defaultWriter);
+
+    DataBuffer payload = credit(80);
+    payload.push_back(0x03);
+    const auto expected =
+        helper::createControlFrame(testingPort, 4, messages::Control::CreditUpdate, payload);
+    EXPECT_EQ(expected, receiver_->writeBuffer);
+}
 }
 
 
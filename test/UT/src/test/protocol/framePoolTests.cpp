@@ -0,0 +1,86 @@
+#include "protocol/framePool.hpp"
+
+#include <gtest/gtest.h>
+
+#include "stub/allocationCounter.hpp"
+
+namespace protocol
+{
+
+TEST(FramePoolShould, GrowByBlocks)
+{
+    FramePool pool(sizeof(Frame<>), 4);
+    EXPECT_EQ(0, pool.capacity());
+
+    auto frame = pool.allocate();
+    EXPECT_EQ(4, pool.capacity());
+    EXPECT_EQ(3, pool.available());
+
+    pool.reserve(9);
+    EXPECT_EQ(12, pool.capacity());
+    EXPECT_EQ(11, pool.available());
+}
+
+TEST(FramePoolShould, ReuseReleasedFrames)
+{
+    FramePool pool(sizeof(Frame<>), 2);
+    auto frame = pool.allocate();
+    frame->port(3);
+    frame->number(7);
+    const u8 data[] = {1, 2, 3};
+    frame->payload(static_cast<const u8*>(data), sizeof(data));
+    const IFrame* released = frame.get();
+    frame.reset();
+    EXPECT_EQ(2, pool.available());
+
+    auto reused = pool.allocate();
+    EXPECT_EQ(released, reused.get());
+    EXPECT_EQ(0, reused->port());
+    EXPECT_EQ(0, reused->number());
+    EXPECT_EQ(0, reused->length());
+    EXPECT_EQ(MaxPayloadSize, reused->payloadSize());
+}
+
+TEST(FramePoolShould, NotAllocateWhenReserved)
+{
+    FramePool pool;
+    pool.reserve(16);
+    std::vector<IFrame::FramePtr> frames;
+    frames.reserve(16);
+
+    const u64 allocations = stub::allocation::count();
+    for (int i = 0; i < 16; ++i)
+    {
+        frames.push_back(pool.allocate());
+    }
+    frames.clear();
+    const u64 allocationsAfterUse = stub::allocation::count();
+
+    EXPECT_EQ(allocations, allocationsAfterUse);
+    EXPECT_EQ(16, pool.available());
+}
+
+TEST(FramePoolShould, PlaceSmallFramesInSmallSlots)
+{
+    FramePool pool(sizeof(Frame<8>), 2);
+    auto small = pool.allocate<Frame<8>>();
+    EXPECT_EQ(1, pool.available());
+
+    // doesn't fit into slot
+    auto big = pool.allocate<Frame<>>();
+    EXPECT_EQ(1, pool.available());
+    EXPECT_EQ(MaxPayloadSize, big->payloadSize());
+
+    small.reset();
+    big.reset();
+    EXPECT_EQ(2, pool.available());
+}
+
+TEST(FramePoolShould, DeleteFramesCreatedOutsideOfPool)
+{
+    IFrame::FramePtr frame(new Frame<4>());
+    frame->number(1);
+    EXPECT_EQ(1, frame->number());
+}
+
+} // namespace protocol
@@ -69,4 +69,42 @@ TEST(FrameShould, NotOverflow)
     EXPECT_THAT(frame.payload(), ArrayCompare(insertedPayload2, sizeof(insertedPayload2)));
 }
 
+TEST(FrameShould, AppendPayload)
+{
+    Frame<6> frame;
+    const u8 payload[] = {1, 2, 3, 4, 5, 6, 7};
+
+    EXPECT_EQ(2, frame.payload(payload, 2));
+    EXPECT_EQ(3, frame.payload(payload + 2, 3));
+    EXPECT_EQ(1, frame.payload(payload + 5, 2));
+    EXPECT_EQ(6, frame.length());
+    EXPECT_THAT(frame.payload(), ArrayCompare(payload, 6));
+}
+
+TEST(FrameShould, AccumulateCrcWhilePayloadIsAppended)
+{
+    Frame<10> frame;
+    const u8 payload[] = {0x12, 0xaa, 0x11, 0x00, 0xff, 0x31, 0x42};
+
+    EXPECT_EQ(0, frame.crc());
+    frame.payload(payload, 3);
+    EXPECT_EQ(crc::Crc16Arc::calculate(BufferSpan{payload, 3}), frame.crc());
+    frame.payload(payload + 3, 4);
+    EXPECT_EQ(crc::Crc16Arc::calculate(payload), frame.crc());
+
+    frame.clear();
+    EXPECT_EQ(0, frame.crc());
+}
+
+TEST(FrameShould, HoldPayloadAbove255Bytes)
+{
+    Frame<1000> frame;
+    const DataBuffer payload(1200, 0x5a);
+
+    EXPECT_EQ(1000, frame.payloadSize());
+    EXPECT_EQ(600, frame.payload(payload.data(), 600));
+    EXPECT_EQ(400, frame.payload(payload.data(), 600));
+    EXPECT_EQ(1000, frame.length());
+}
+
 } // namespace protocol
@@ -0,0 +1,314 @@
+#include <gtest/gtest.h>
+
+#include "protocol/linkNegotiator.hpp"
+
+#include "protocol/frameHandler.hpp"
+#include "protocol/stuffer.hpp"
+#include "timer/manager.hpp"
+
+#include "stub/receiverStub.hpp"
+#include "stub/timeStub.hpp"
+
+namespace protocol
+{
+
+namespace
+{
+
+const u32 StartBaudrate = 9600;
+
+struct Peer
+{
+    Peer(timer::Manager& timerManager, const Capabilities& capabilities)
+        : connection(std::make_shared<stub::ReceiverStub>()), baudrate(StartBaudrate),
+          negotiator(handler, timerManager, StartBaudrate, capabilities), settled(false)
+    {
+        handler.setConnection(connection);
+        negotiator.setBaudrateSetter([this](u32 newBaudrate) { baudrate = newBaudrate; });
+        negotiator.setAgreementHandler([this](const Capabilities& capabilities) {
+            agreed = capabilities;
+            settled = true;
+        });
+    }
+
+    std::shared_ptr<stub::ReceiverStub> connection;
+    FrameHandler handler;
+    u32 baudrate;
+    LinkNegotiator negotiator;
+    Capabilities agreed;
+    bool settled;
+};
+
+} // namespace
+
+class LinkNegotiatorShould : public ::testing::Test
+{
+public:
+    LinkNegotiatorShould()
+        : initiator_(timerManager_, {115200, Capabilities::BasicFrames, 0}),
+          responder_(timerManager_,
+                     {460800, Capabilities::BasicFrames | Capabilities::ExtendedFrames, 0}),
+          linkBroken_(false)
+    {
+        stub::time::setCurrentTime(0);
+    }
+
+protected:
+    // UART delivers bytes only when both sides use the same speed
+    void transfer(Peer& from, Peer& to)
+    {
+        DataBuffer data;
+        data.swap(from.connection->writeBuffer);
+        if (!data.empty() && from.baudrate == to.baudrate && !linkBroken_)
+        {
+            to.connection->readerCallback(BufferSpan{data}, defaultWriter);
+        }
+    }
+
+    void run(const u32 milliseconds)
+    {
+        run(initiator_, responder_, timerManager_, milliseconds);
+    }
+
+    void run(Peer& initiator, Peer& responder, timer::Manager& timerManager,
+             const u32 milliseconds)
+    {
+        for (u32 i = 0; i < milliseconds; i += 10)
+        {
+            transfer(initiator, responder);
+            transfer(responder, initiator);
+            stub::time::forwardTime(10);
+            timerManager.run();
+        }
+    }
+
+    timer::Manager timerManager_;
+    Peer initiator_;
+    Peer responder_;
+    bool linkBroken_;
+};
+
+TEST(LinkNegotiatorAgreementShould, TakeWhatBothPeersSupport)
+{
+    const Capabilities agreed =
+        LinkNegotiator::agree({460800, Capabilities::BasicFrames, 0x03},
+                              {115200, Capabilities::BasicFrames, 0x06});
+
+    EXPECT_EQ(115200u, agreed.maxBaudrate);
+    EXPECT_EQ(Capabilities::BasicFrames, agreed.frameFormats);
+    EXPECT_EQ(0x02, agreed.compression);
+}
+
+TEST_F(LinkNegotiatorShould, MoveBothPeersToCommonSettings)
+{
+    initiator_.negotiator.negotiate();
+    EXPECT_TRUE(initiator_.negotiator.negotiating());
+
+    run(1000);
+
+    EXPECT_TRUE(initiator_.settled);
+    EXPECT_TRUE(responder_.settled);
+    EXPECT_FALSE(initiator_.negotiator.negotiating());
+    EXPECT_FALSE(responder_.negotiator.negotiating());
+    EXPECT_EQ(115200u, initiator_.baudrate);
+    EXPECT_EQ(115200u, responder_.baudrate);
+    EXPECT_EQ(115200u, initiator_.agreed.maxBaudrate);
+    EXPECT_FALSE(initiator_.handler.extendedFrames());
+    EXPECT_FALSE(responder_.handler.extendedFrames());
+}
+
+TEST_F(LinkNegotiatorShould, GoBackToPreviousBaudrateWhenCheckFails)
+{
+    initiator_.negotiator.negotiate();
+    // exchange at old speed passes, nothing gets through after switch
+    run(20);
+    linkBroken_ = true;
+    run(3000);
+
+    EXPECT_TRUE(initiator_.settled);
+    EXPECT_TRUE(responder_.settled);
+    EXPECT_EQ(StartBaudrate, initiator_.baudrate);
+    EXPECT_EQ(StartBaudrate, responder_.baudrate);
+    EXPECT_EQ(StartBaudrate, initiator_.negotiator.baudrate());
+    EXPECT_EQ(StartBaudrate, responder_.agreed.maxBaudrate);
+
+    // peers talk again at old speed
+    linkBroken_ = false;
+    initiator_.settled = false;
+    responder_.settled = false;
+    initiator_.negotiator.negotiate();
+    run(1000);
+    EXPECT_TRUE(responder_.settled);
+    EXPECT_EQ(115200u, initiator_.baudrate);
+    EXPECT_EQ(115200u, responder_.baudrate);
+}
+
+TEST_F(LinkNegotiatorShould, GoBackToPreviousBaudrateWhenConfirmationIsLost)
+{
+    initiator_.negotiator.negotiate();
+    // responder answers check at new speed, nothing from initiator gets through after that
+    bool checked = false;
+    for (u32 i = 0; i < 5000; i += 10)
+    {
+        linkBroken_ = checked;
+        transfer(initiator_, responder_);
+        checked = checked || (responder_.baudrate != StartBaudrate &&
+                              !responder_.connection->writeBuffer.empty());
+        linkBroken_ = false;
+        transfer(responder_, initiator_);
+        stub::time::forwardTime(10);
+        timerManager_.run();
+    }
+
+    EXPECT_TRUE(checked);
+    EXPECT_TRUE(initiator_.settled);
+    EXPECT_TRUE(responder_.settled);
+    EXPECT_FALSE(initiator_.negotiator.negotiating());
+    EXPECT_FALSE(responder_.negotiator.negotiating());
+    EXPECT_EQ(StartBaudrate, initiator_.baudrate);
+    EXPECT_EQ(StartBaudrate, responder_.baudrate);
+}
+
+TEST_F(LinkNegotiatorShould, KeepSettingsWhenPeerDoesNotAnswer)
+{
+    linkBroken_ = true;
+    initiator_.negotiator.negotiate();
+    run(5000);
+
+    EXPECT_FALSE(initiator_.negotiator.negotiating());
+    EXPECT_FALSE(initiator_.settled);
+    EXPECT_EQ(StartBaudrate, initiator_.baudrate);
+}
+
+TEST_F(LinkNegotiatorShould, EnableFrameFormatsSupportedByBothPeers)
+{
+    timer::Manager timerManager;
+    const u8 formats = Capabilities::BasicFrames | Capabilities::ExtendedFrames;
+    Peer initiator(timerManager, {StartBaudrate, formats | Capabilities::StuffedFrames, 0});
+    Peer responder(timerManager, {StartBaudrate, formats, 0});
+
+    initiator.negotiator.negotiate();
+    transfer(initiator, responder);
+    transfer(responder, initiator);
+    // same baudrate, new format is confirmed by one link check
+    EXPECT_TRUE(initiator.handler.extendedFrames());
+    EXPECT_TRUE(responder.handler.extendedFrames());
+    transfer(initiator, responder);
+    transfer(responder, initiator);
+
+    EXPECT_TRUE(initiator.settled);
+    EXPECT_TRUE(responder.settled);
+    EXPECT_TRUE(initiator.handler.extendedFrames());
+    EXPECT_TRUE(responder.handler.extendedFrames());
+    EXPECT_FALSE(initiator.handler.stuffing());
+    EXPECT_FALSE(responder.handler.stuffing());
+}
+
+TEST_F(LinkNegotiatorShould, SwitchBothPeersToStuffedFrames)
+{
+    timer::Manager timerManager;
+    const Capabilities capabilities{StartBaudrate,
+                                    Capabilities::BasicFrames | Capabilities::StuffedFrames, 0};
+    Peer initiator(timerManager, capabilities);
+    Peer responder(timerManager, capabilities);
+
+    initiator.negotiator.negotiate();
+    transfer(initiator, responder);
+    transfer(responder, initiator);
+    EXPECT_TRUE(initiator.handler.stuffing());
+    EXPECT_TRUE(responder.handler.stuffing());
+    // link check already goes in stuffed frame
+    EXPECT_EQ(Delimiter, initiator.connection->writeBuffer.back());
+    transfer(initiator, responder);
+    transfer(responder, initiator);
+    EXPECT_TRUE(initiator.settled);
+    EXPECT_TRUE(responder.settled);
+
+    // next exchange keeps stuffed frames and settles at once
+    initiator.settled = false;
+    responder.settled = false;
+    initiator.negotiator.negotiate();
+    EXPECT_EQ(Delimiter, initiator.connection->writeBuffer.back());
+    transfer(initiator, responder);
+    transfer(responder, initiator);
+    EXPECT_TRUE(initiator.settled);
+    EXPECT_TRUE(responder.settled);
+}
+
+TEST_F(LinkNegotiatorShould, RecoverWhenAnswerSwitchingFormatIsLost)
+{
+    timer::Manager timerManager;
+    const Capabilities capabilities{StartBaudrate,
+                                    Capabilities::BasicFrames | Capabilities::StuffedFrames, 0};
+    Peer initiator(timerManager, capabilities);
+    Peer responder(timerManager, capabilities);
+
+    initiator.negotiator.negotiate();
+    transfer(initiator, responder);
+    EXPECT_TRUE(responder.handler.stuffing());
+    responder.connection->writeBuffer.clear();
+
+    // retried requests in plain frames aren't read until responder goes back to them
+    run(initiator, responder, timerManager, 5000);
+    EXPECT_FALSE(initiator.negotiator.negotiating());
+    EXPECT_FALSE(responder.negotiator.negotiating());
+    EXPECT_EQ(initiator.handler.stuffing(), responder.handler.stuffing());
+
+    initiator.negotiator.negotiate();
+    run(initiator, responder, timerManager, 1000);
+    EXPECT_TRUE(initiator.handler.stuffing());
+    EXPECT_TRUE(responder.handler.stuffing());
+    EXPECT_FALSE(responder.negotiator.negotiating());
+}
+
+TEST_F(LinkNegotiatorShould, GoBackToPreviousFormatWhenCheckInNewFormatFails)
+{
+    timer::Manager timerManager;
+    const Capabilities capabilities{StartBaudrate,
+                                    Capabilities::BasicFrames | Capabilities::StuffedFrames, 0};
+    Peer initiator(timerManager, capabilities);
+    Peer responder(timerManager, capabilities);
+
+    initiator.negotiator.negotiate();
+    transfer(initiator, responder);
+    transfer(responder, initiator);
+    linkBroken_ = true;
+    run(initiator, responder, timerManager, 3000);
+
+    EXPECT_TRUE(initiator.settled);
+    EXPECT_TRUE(responder.settled);
+    EXPECT_FALSE(initiator.handler.stuffing());
+    EXPECT_FALSE(responder.handler.stuffing());
+    EXPECT_EQ(0, responder.agreed.frameFormats & Capabilities::StuffedFrames);
+}
+
+TEST_F(LinkNegotiatorShould, StopListeningWhenDestroyed)
+{
+    timer::Manager timerManager;
+    FrameHandler handler;
+    const auto connection(std::make_shared<stub::ReceiverStub>());
+    handler.setConnection(connection);
+    {
+        LinkNegotiator negotiator(handler, timerManager, StartBaudrate,
+                                  {StartBaudrate, Capabilities::BasicFrames, 0});
+        negotiator.negotiate();
+    }
+
+    // request isn't repeated after destruction
+    connection->clearBuffers();
+    stub::time::forwardTime(1000);
+    timerManager.run();
+    EXPECT_EQ(0, connection->writeCalls);
+
+    // and peer's request isn't answered
+    FrameHandler peer;
+    const auto peerConnection(std::make_shared<stub::ReceiverStub>());
+    peer.setConnection(peerConnection);
+    Frame<1> request(LinkControlPort, 0);
+    request.control(messages::Control::CapabilityRequest);
+    peer.send(request);
+    connection->readerCallback(BufferSpan{peerConnection->writeBuffer}, defaultWriter);
+    EXPECT_EQ(0, connection->writeCalls);
+}
+
+} // namespace protocol
@@ -0,0 +1,226 @@
+#include "protocol/packetAssembler.hpp"
+
+#include <gtest/gtest.h>
+
+#include "protocol/crc.hpp"
+#include "protocol/frame.hpp"
+#include "protocol/limits.hpp"
+#include "serializer/serializer.hpp"
+
+namespace protocol
+{
+
+namespace
+{
+
+struct ReceivedPacket
+{
+    u16 port;
+    DataBuffer data;
+};
+
+DataBuffer createPayload(const std::size_t size)
+{
+    DataBuffer payload(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        payload[i] = static_cast<u8>(i * 7 + 3);
+    }
+    return payload;
+}
+
+DataBuffer createHeaderPayload(const DataBuffer& data, const u8 messageNumber)
+{
+    DataBuffer header(6);
+    serializer::serialize(header.data(), static_cast<u16>(data.size()));
+    header[2] = messageNumber;
+    serializer::serialize(&header[4], crc::Crc16Arc::calculate(BufferSpan{header.data(), 4}));
+    return header;
+}
+
+DataBuffer createCrcPayload(const DataBuffer& data)
+{
+    DataBuffer crc(4);
+    serializer::serialize(crc.data(), crc::Crc32::calculate(data));
+    return crc;
+}
+
+BufferSpan dataFrame(const DataBuffer& data, const u8 frameNumber)
+{
+    const std::size_t offset = static_cast<std::size_t>(frameNumber - 1) * MaxPayloadSize;
+    const std::size_t size = std::min<std::size_t>(MaxPayloadSize, data.size() - offset);
+    return BufferSpan{&data[offset], static_cast<BufferIndexType>(size)};
+}
+
+class PacketAssemblerShould : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        assembler_.setReceiver([this](u16 port, const BufferSpan& packet) {
+            received_.push_back(ReceivedPacket{port, DataBuffer(packet.begin(), packet.end())});
+        });
+    }
+
+    PacketAssembler assembler_;
+    std::vector<ReceivedPacket> received_;
+};
+
+} // namespace
+
+TEST_F(PacketAssemblerShould, AssemblePacket)
+{
+    const auto payload = createPayload(600);
+    const auto header = createHeaderPayload(payload, 0);
+    const auto crc = createCrcPayload(payload);
+
+    assembler_.append(1, 0, header);
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    assembler_.append(1, 2, dataFrame(payload, 2));
+    assembler_.append(1, 3, dataFrame(payload, 3));
+    EXPECT_EQ(0, received_.size());
+    assembler_.append(1, 4, crc);
+
+    ASSERT_EQ(1, received_.size());
+    EXPECT_EQ(1, received_[0].port);
+    EXPECT_EQ(payload, received_[0].data);
+    EXPECT_EQ(0, assembler_.packetsInProgress());
+}
+
+TEST_F(PacketAssemblerShould, PlaceFramesReceivedOutOfOrder)
+{
+    const auto payload = createPayload(600);
+    const auto header = createHeaderPayload(payload, 0);
+    const auto crc = createCrcPayload(payload);
+
+    assembler_.append(1, 0, header);
+    assembler_.append(1, 4, crc);
+    assembler_.append(1, 3, dataFrame(payload, 3));
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    EXPECT_EQ(0, received_.size());
+    assembler_.append(1, 2, dataFrame(payload, 2));
+
+    ASSERT_EQ(1, received_.size());
+    EXPECT_EQ(payload, received_[0].data);
+}
+
+TEST_F(PacketAssemblerShould, IgnoreDuplicatedFrames)
+{
+    const auto payload = createPayload(300);
+    const auto header = createHeaderPayload(payload, 3);
+    const auto crc = createCrcPayload(payload);
+
+    assembler_.append(1, 0, header);
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    assembler_.append(1, 0, header);
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    assembler_.append(1, 2, dataFrame(payload, 2));
+    assembler_.append(1, 3, crc);
+    // retransmissions of already delivered packet
+    assembler_.append(1, 2, dataFrame(payload, 2));
+    assembler_.append(1, 3, crc);
+
+    ASSERT_EQ(1, received_.size());
+    EXPECT_EQ(payload, received_[0].data);
+}
+
+TEST_F(PacketAssemblerShould, AssemblePacketsFromDifferentPortsConcurrently)
+{
+    const auto first = createPayload(400);
+    const auto second = DataBuffer(300, 0x5a);
+
+    assembler_.append(1, 0, createHeaderPayload(first, 0));
+    assembler_.append(2, 0, createHeaderPayload(second, 0));
+    assembler_.append(2, 1, dataFrame(second, 1));
+    assembler_.append(1, 1, dataFrame(first, 1));
+    assembler_.append(1, 2, dataFrame(first, 2));
+    assembler_.append(2, 2, dataFrame(second, 2));
+    EXPECT_EQ(2, assembler_.packetsInProgress());
+
+    assembler_.append(2, 3, createCrcPayload(second));
+    assembler_.append(1, 3, createCrcPayload(first));
+
+    ASSERT_EQ(2, received_.size());
+    EXPECT_EQ(2, received_[0].port);
+    EXPECT_EQ(second, received_[0].data);
+    EXPECT_EQ(1, received_[1].port);
+    EXPECT_EQ(first, received_[1].data);
+}
+
+TEST_F(PacketAssemblerShould, ReplacePacketAbandonedBySender)
+{
+    const auto abandoned = createPayload(400);
+    const auto payload = DataBuffer(100, 0x11);
+
+    assembler_.append(1, 0, createHeaderPayload(abandoned, 0));
+    assembler_.append(1, 1, dataFrame(abandoned, 1));
+    assembler_.append(1, 0, createHeaderPayload(payload, 1));
+    EXPECT_EQ(1, assembler_.packetsInProgress());
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    assembler_.append(1, 2, createCrcPayload(payload));
+
+    ASSERT_EQ(1, received_.size());
+    EXPECT_EQ(payload, received_[0].data);
+}
+
+TEST_F(PacketAssemblerShould, RejectFramesWithWrongSize)
+{
+    const auto payload = createPayload(300);
+    const DataBuffer tooShort(10, 0);
+
+    assembler_.append(1, 0, createHeaderPayload(payload, 0));
+    assembler_.append(1, 1, tooShort);
+    assembler_.append(1, 2, dataFrame(payload, 2));
+    assembler_.append(1, 3, createCrcPayload(payload));
+    EXPECT_EQ(0, received_.size());
+
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    ASSERT_EQ(1, received_.size());
+    EXPECT_EQ(payload, received_[0].data);
+}
+
+TEST_F(PacketAssemblerShould, DropPacketWithWrongCrc)
+{
+    const auto payload = createPayload(100);
+    DataBuffer crc = createCrcPayload(payload);
+    crc[0] ^= 0xff;
+
+    assembler_.append(1, 0, createHeaderPayload(payload, 0));
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    assembler_.append(1, 2, crc);
+
+    EXPECT_EQ(0, received_.size());
+    EXPECT_EQ(0, assembler_.packetsInProgress());
+}
+
+TEST_F(PacketAssemblerShould, IgnoreHeaderWithWrongCrc)
+{
+    const auto payload = createPayload(100);
+    auto header = createHeaderPayload(payload, 0);
+    header[4] ^= 0xff;
+
+    assembler_.append(1, 0, header);
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    assembler_.append(1, 2, createCrcPayload(payload));
+
+    EXPECT_EQ(0, received_.size());
+    EXPECT_EQ(0, assembler_.packetsInProgress());
+}
+
+TEST_F(PacketAssemblerShould, IgnoreHeaderAnnouncingPacketAboveMaxSize)
+{
+    const auto payload = createPayload(100);
+    const DataBuffer tooLarge(MaxPacketSize + 1);
+
+    assembler_.append(1, 0, createHeaderPayload(payload, 0));
+    assembler_.append(1, 0, createHeaderPayload(tooLarge, 1));
+    EXPECT_EQ(1, assembler_.packetsInProgress());
+
+    // packet in progress isn't replaced by rejected header
+    assembler_.append(1, 1, dataFrame(payload, 1));
+    assembler_.append(1, 2, createCrcPayload(payload));
+    ASSERT_EQ(1, received_.size());
+    EXPECT_EQ(payload, received_[0].data);
+}
+
+} // namespace protocol
@@ -2,10 +2,14 @@
 
 #include "protocol/packetHandler.hpp"
 
+#include "hal/time/time.hpp"
+#include "serializer/serializer.hpp"
 #include "timer/manager.hpp"
+#include "timer/wheelManager.hpp"
 
 #include "helper/frameHelper.hpp"
 #include "matcher/arrayCompare.hpp"
+#include "stub/allocationCounter.hpp"
 #include "stub/receiverStub.hpp"
 #include "stub/timeStub.hpp"
 
@@ -80,6 +84,8 @@ TEST(PacketHandlerShould, RetransmitParts)
     timer::Manager timerManager;
 
     PacketHandler packetHandler(testingPort, receiver, timerManager);
+    // acks come immediately, keep timeout from dropping below 400 ms
+    packetHandler.setRetransmissionTimeoutLimits(400, 8000);
     DataBuffer testingPayload = {0xa, 0xb, 0xc, 0xd};
     testingPayload.resize(300);
     testingPayload.push_back(0xab);
@@ -148,4 +154,1038 @@ TEST(PacketHandlerShould, RetransmitParts)
     EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(crcPart.data(), crcPart.size()));
     receiver->writeBuffer.clear();
 }
+
+namespace
+{
+
+DataBuffer createPayload(std::size_t size)
+{
+    DataBuffer payload(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        payload[i] = static_cast<u8>(i * 7 + 3);
+    }
+    return payload;
+}
+
+void agreeWindowSize(PacketHandler& packetHandler, stub::ReceiverStub& receiver, u16 port,
+                     u8 windowSize)
+{
+    packetHandler.setMaxWindowSize(windowSize);
+    packetHandler.negotiateWindowSize();
+    auto response = helper::createControlFrame(
+        port, 0, messages::Control::WindowSizeResponse, DataBuffer{windowSize});
+    receiver.readerCallback(response, defaultWriter);
+    receiver.clearBuffers();
+}
+
+} // namespace
+
+TEST(PacketHandlerShould, NegotiateWindowSize)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    packetHandler.setMaxWindowSize(8);
+    EXPECT_EQ(1, packetHandler.windowSize());
+
+    packetHandler.negotiateWindowSize();
+    auto request = helper::createControlFrame(testingPort, 0, messages::Control::WindowSizeRequest,
+                                              DataBuffer{8});
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(request.data(), request.size()));
+    receiver->clearBuffers();
+
+    // lost response
+    stub::time::forwardTime(450);
+    timerManager.run();
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(request.data(), request.size()));
+
+    auto response = helper::createControlFrame(
+        testingPort, 0, messages::Control::WindowSizeResponse, DataBuffer{4});
+    receiver->readerCallback(response, defaultWriter);
+    EXPECT_EQ(4, packetHandler.windowSize());
+}
+
+TEST(PacketHandlerShould, AnswerWindowSizeRequestWithSmallerWindow)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    packetHandler.setMaxWindowSize(3);
+
+    auto request = helper::createControlFrame(testingPort, 0, messages::Control::WindowSizeRequest,
+                                              DataBuffer{8});
+    receiver->readerCallback(request, defaultWriter);
+
+    auto response = helper::createControlFrame(
+        testingPort, 0, messages::Control::WindowSizeResponse, DataBuffer{3});
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(response.data(), response.size()));
+    EXPECT_EQ(3, packetHandler.windowSize());
+}
+
+TEST(PacketHandlerShould, SendWindowOfFramesAfterHeaderIsConfirmed)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    agreeWindowSize(packetHandler, *receiver, testingPort, 4);
+
+    // 5 data frames and CRC frame
+    const auto testingPayload = createPayload(5 * MaxPayloadSize);
+    packetHandler.send(testingPayload);
+    EXPECT_EQ(1, receiver->writeCalls);
+
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    EXPECT_EQ(4, receiver->writeCalls);
+    DataBuffer expectedWindow;
+    for (u8 number = 1; number <= 4; ++number)
+    {
+        const auto frame =
+            helper::createFrame(testingPayload, testingPort, number, (number - 1) * MaxPayloadSize);
+        expectedWindow.insert(expectedWindow.end(), frame.begin(), frame.end());
+    }
+    EXPECT_THAT(receiver->writeBuffer.data(),
+                ArrayCompare(expectedWindow.data(), expectedWindow.size()));
+
+    // window doesn't move until oldest frame is confirmed
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 2), defaultWriter);
+    EXPECT_EQ(0, receiver->writeCalls);
+
+    receiver->readerCallback(helper::createAck(testingPort, 1), defaultWriter);
+    EXPECT_EQ(2, receiver->writeCalls);
+    auto expectedFrames = helper::createFrame(testingPayload, testingPort, 5, 4 * MaxPayloadSize);
+    const auto crcFrame = helper::createCrc32Frame(testingPort, 6, testingPayload);
+    expectedFrames.insert(expectedFrames.end(), crcFrame.begin(), crcFrame.end());
+    EXPECT_THAT(receiver->writeBuffer.data(),
+                ArrayCompare(expectedFrames.data(), expectedFrames.size()));
+}
+
+TEST(PacketHandlerShould, RetransmitOnlyLostFrames)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    agreeWindowSize(packetHandler, *receiver, testingPort, 4);
+
+    const auto testingPayload = createPayload(3 * MaxPayloadSize);
+    packetHandler.send(testingPayload);
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    receiver->readerCallback(helper::createAck(testingPort, 1), defaultWriter);
+    receiver->readerCallback(helper::createAck(testingPort, 3), defaultWriter);
+    receiver->readerCallback(helper::createAck(testingPort, 4), defaultWriter);
+    receiver->clearBuffers();
+
+    stub::time::forwardTime(450);
+    timerManager.run();
+    const auto lostFrame = helper::createFrame(testingPayload, testingPort, 2, MaxPayloadSize);
+    EXPECT_EQ(1, receiver->writeCalls);
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(lostFrame.data(), lostFrame.size()));
+
+    // after confirmation of whole packet next one starts with header
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 2), defaultWriter);
+    EXPECT_EQ(0, receiver->writeCalls);
+    packetHandler.send(testingPayload);
+    const auto header = helper::createHeader(testingPayload, testingPort, 1, 0);
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(header.data(), header.size()));
+}
+
+TEST(PacketHandlerShould, ReceivePacket)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    DataBuffer receivedPacket;
+    int receivedPackets = 0;
+    packetHandler.setPacketReceiver([&](const BufferSpan& packet) {
+        receivedPacket.assign(packet.begin(), packet.end());
+        ++receivedPackets;
+    });
+
+    const auto testingPayload = createPayload(300);
+    receiver->readerCallback(helper::createHeader(testingPayload, testingPort, 0, 0),
+                             defaultWriter);
+    receiver->readerCallback(helper::createFrame(testingPayload, testingPort, 1, 0),
+                             defaultWriter);
+    receiver->readerCallback(helper::createFrame(testingPayload, testingPort, 2, MaxPayloadSize),
+                             defaultWriter);
+    EXPECT_EQ(0, receivedPackets);
+    receiver->readerCallback(helper::createCrc32Frame(testingPort, 3, testingPayload),
+                             defaultWriter);
+
+    EXPECT_EQ(1, receivedPackets);
+    EXPECT_EQ(testingPayload, receivedPacket);
+
+    // retransmission of CRC frame is ignored
+    receiver->readerCallback(helper::createCrc32Frame(testingPort, 3, testingPayload),
+                             defaultWriter);
+    EXPECT_EQ(1, receivedPackets);
+}
+
+TEST(PacketHandlerShould, ReassembleFramesReceivedOutOfOrder)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    packetHandler.setMaxWindowSize(4);
+    DataBuffer receivedPacket;
+    int receivedPackets = 0;
+    packetHandler.setPacketReceiver([&](const BufferSpan& packet) {
+        receivedPacket.assign(packet.begin(), packet.end());
+        ++receivedPackets;
+    });
+
+    const auto testingPayload = createPayload(3 * MaxPayloadSize);
+    receiver->readerCallback(helper::createHeader(testingPayload, testingPort, 0, 0),
+                             defaultWriter);
+    // first frame lost
+    receiver->readerCallback(helper::createFrame(testingPayload, testingPort, 2, MaxPayloadSize),
+                             defaultWriter);
+    receiver->readerCallback(
+        helper::createFrame(testingPayload, testingPort, 3, 2 * MaxPayloadSize), defaultWriter);
+    receiver->readerCallback(helper::createCrc32Frame(testingPort, 4, testingPayload),
+                             defaultWriter);
+    EXPECT_EQ(0, receivedPackets);
+
+    receiver->readerCallback(helper::createFrame(testingPayload, testingPort, 1, 0),
+                             defaultWriter);
+    EXPECT_EQ(1, receivedPackets);
+    EXPECT_EQ(testingPayload, receivedPacket);
+}
+
+TEST(PacketHandlerShould, DropPacketWithWrongCrc)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    int receivedPackets = 0;
+    packetHandler.setPacketReceiver([&](const BufferSpan& /*packet*/) { ++receivedPackets; });
+
+    const auto testingPayload = createPayload(100);
+    receiver->readerCallback(helper::createHeader(testingPayload, testingPort, 0, 0),
+                             defaultWriter);
+    receiver->readerCallback(helper::createFrame(testingPayload, testingPort, 1, 0),
+                             defaultWriter);
+    receiver->readerCallback(helper::createCrc32Frame(testingPort, 2, createPayload(99)),
+                             defaultWriter);
+    EXPECT_EQ(0, receivedPackets);
+}
+
+TEST(PacketHandlerShould, AdaptRetransmissionTimeoutToRoundTripTime)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    EXPECT_EQ(400, packetHandler.rto());
+
+    const auto testingPayload = createPayload(3 * MaxPayloadSize);
+    packetHandler.send(testingPayload);
+    stub::time::forwardTime(40);
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    EXPECT_EQ(40, packetHandler.rtt());
+    EXPECT_EQ(120, packetHandler.rto());
+
+    // lost frame is retransmitted after estimated timeout, which is backed off
+    receiver->clearBuffers();
+    stub::time::forwardTime(119);
+    timerManager.run();
+    EXPECT_EQ(0, receiver->writeCalls);
+    stub::time::forwardTime(1);
+    timerManager.run();
+    EXPECT_EQ(1, receiver->writeCalls);
+    EXPECT_EQ(240, packetHandler.rto());
+
+    // ack of retransmitted frame isn't sampled
+    stub::time::forwardTime(10);
+    receiver->readerCallback(helper::createAck(testingPort, 1), defaultWriter);
+    EXPECT_EQ(40, packetHandler.rtt());
+    EXPECT_EQ(240, packetHandler.rto());
+
+    stub::time::forwardTime(40);
+    receiver->readerCallback(helper::createAck(testingPort, 2), defaultWriter);
+    EXPECT_EQ(40, packetHandler.rtt());
+    EXPECT_EQ(100, packetHandler.rto());
+}
+
+namespace
+{
+u64 clockMicroseconds = 0;
+
+u64 microsecondClock()
+{
+    return clockMicroseconds;
+}
+} // namespace
+
+TEST(PacketHandlerShould, SampleRoundTripShorterThanMillisecond)
+{
+    clockMicroseconds = 100;
+    hal::time::setClock(&microsecondClock);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    const auto testingPayload = createPayload(3 * MaxPayloadSize);
+    packetHandler.send(testingPayload);
+
+    // fast link answers within the same millisecond, round trip counts as one, not zero
+    clockMicroseconds = 400;
+    hal::time::tick();
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    EXPECT_EQ(1, packetHandler.rtt());
+
+    stub::time::setCurrentTime(0);
+}
+
+TEST(PacketHandlerShould, CancelTimersWhenDestroyedWithFramesInFlight)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto connection(std::make_shared<stub::ReceiverStub>());
+    timer::WheelManager timerManager;
+    FrameHandler link;
+    link.setConnection(connection);
+
+    {
+        PacketHandler packetHandler(testingPort, link, timerManager);
+        packetHandler.send(createPayload(3 * MaxPayloadSize));
+        connection->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+        EXPECT_GT(timerManager.capacity(), timerManager.available());
+    }
+
+    // link keeps running, retransmission timers of the handler are gone with it
+    EXPECT_EQ(timerManager.capacity(), timerManager.available());
+    connection->clearBuffers();
+    stub::time::forwardTime(10000);
+    timerManager.run();
+    EXPECT_EQ(0, connection->writeCalls);
+}
+
+TEST(PacketHandlerShould, RetransmitImmediatelyOnNack)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    const auto testingPayload = createPayload(3 * MaxPayloadSize);
+    packetHandler.send(testingPayload);
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+
+    const auto frame = helper::createFrame(testingPayload, testingPort, 1, 0);
+    for (const u8 control : {messages::Control::CrcChecksumFailed, messages::Control::WrongEndByte,
+                             messages::Control::PortNotConnect})
+    {
+        receiver->clearBuffers();
+        receiver->readerCallback(helper::createControlFrame(testingPort, 1, control, {}),
+                                 defaultWriter);
+        EXPECT_EQ(1, receiver->writeCalls);
+        EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(frame.data(), frame.size()));
+    }
+
+    // frame outside of window
+    receiver->clearBuffers();
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 2, messages::Control::CrcChecksumFailed, {}),
+        defaultWriter);
+    EXPECT_EQ(0, receiver->writeCalls);
+}
+
+TEST(PacketHandlerShould, DropPacketWhenRetryLimitIsReached)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    packetHandler.setRetryLimit(2);
+    std::vector<u8> failedPackets;
+    packetHandler.setFailureHandler(
+        [&failedPackets](u8 messageNumber) { failedPackets.push_back(messageNumber); });
+
+    const auto firstPayload = createPayload(10);
+    const auto secondPayload = createPayload(20);
+    packetHandler.send(firstPayload);
+    packetHandler.send(secondPayload);
+
+    const auto nack =
+        helper::createControlFrame(testingPort, 0, messages::Control::CrcChecksumFailed, {});
+    receiver->readerCallback(nack, defaultWriter);
+    // retransmissions after timeout count as well
+    stub::time::forwardTime(packetHandler.rto());
+    timerManager.run();
+    EXPECT_TRUE(failedPackets.empty());
+
+    receiver->clearBuffers();
+    receiver->readerCallback(nack, defaultWriter);
+    ASSERT_EQ(1, failedPackets.size());
+    EXPECT_EQ(0, failedPackets[0]);
+
+    // next packet starts
+    const auto header = helper::createHeader(secondPayload, testingPort, 1, 0);
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(header.data(), header.size()));
+
+    // timers of dropped packet are cancelled
+    for (u8 number = 0; number < 3; ++number)
+    {
+        receiver->readerCallback(helper::createAck(testingPort, number), defaultWriter);
+    }
+    receiver->clearBuffers();
+    stub::time::forwardTime(10000);
+    timerManager.run();
+    EXPECT_EQ(0, receiver->writeCalls);
+}
+
+namespace
+{
+
+void confirmPacket(stub::ReceiverStub& receiver, u16 port, const DataBuffer& payload)
+{
+    const u8 frames = static_cast<u8>((payload.size() + MaxPayloadSize - 1) / MaxPayloadSize + 2);
+    for (u8 number = 0; number < frames; ++number)
+    {
+        receiver.readerCallback(helper::createAck(port, number), defaultWriter);
+    }
+}
+
+} // namespace
+
+TEST(PacketHandlerShould, SendQueuedPacketsInOrder)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    std::vector<int> completed;
+    const auto firstPayload = createPayload(300);
+    const auto secondPayload = createPayload(20);
+    EXPECT_EQ(SendStatus::Queued,
+              packetHandler.send(firstPayload, Priority::Normal,
+                                 [&completed](bool delivered) {
+                                     EXPECT_TRUE(delivered);
+                                     completed.push_back(1);
+                                 }));
+    EXPECT_EQ(SendStatus::Queued,
+              packetHandler.send(secondPayload, Priority::Normal,
+                                 [&completed](bool delivered) {
+                                     EXPECT_TRUE(delivered);
+                                     completed.push_back(2);
+                                 }));
+
+    // second packet doesn't disturb the one in flight
+    const auto firstHeader = helper::createHeader(firstPayload, testingPort, 0, 0);
+    EXPECT_THAT(receiver->writeBuffer.data(),
+                ArrayCompare(firstHeader.data(), firstHeader.size()));
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    const auto firstFrame = helper::createFrame(firstPayload, testingPort, 1, 0);
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(firstFrame.data(), firstFrame.size()));
+
+    receiver->readerCallback(helper::createAck(testingPort, 1), defaultWriter);
+    receiver->readerCallback(helper::createAck(testingPort, 2), defaultWriter);
+    receiver->clearBuffers();
+    EXPECT_TRUE(completed.empty());
+    receiver->readerCallback(helper::createAck(testingPort, 3), defaultWriter);
+    EXPECT_EQ(std::vector<int>{1}, completed);
+
+    const auto secondHeader = helper::createHeader(secondPayload, testingPort, 1, 0);
+    EXPECT_THAT(receiver->writeBuffer.data(),
+                ArrayCompare(secondHeader.data(), secondHeader.size()));
+    confirmPacket(*receiver, testingPort, secondPayload);
+    EXPECT_EQ((std::vector<int>{1, 2}), completed);
+}
+
+TEST(PacketHandlerShould, SendHighPriorityPacketAfterPacketInFlight)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    const auto bulk = createPayload(1000);
+    const auto command = createPayload(8);
+    packetHandler.send(bulk);
+    packetHandler.send(bulk);
+    packetHandler.send(command, Priority::High);
+
+    receiver->clearBuffers();
+    confirmPacket(*receiver, testingPort, bulk);
+    const auto commandHeader = helper::createHeader(command, testingPort, 2, 0);
+    auto lastWrite = DataBuffer(receiver->writeBuffer.end() - commandHeader.size(),
+                                receiver->writeBuffer.end());
+    EXPECT_EQ(commandHeader, lastWrite);
+
+    receiver->clearBuffers();
+    confirmPacket(*receiver, testingPort, command);
+    const auto bulkHeader = helper::createHeader(bulk, testingPort, 1, 0);
+    lastWrite = DataBuffer(receiver->writeBuffer.end() - bulkHeader.size(),
+                           receiver->writeBuffer.end());
+    EXPECT_EQ(bulkHeader, lastWrite);
+}
+
+TEST(PacketHandlerShould, RejectPacketsAboveQueueLimit)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    packetHandler.setQueueLimit(Priority::Normal, 600);
+    packetHandler.setQueueLimit(Priority::High, 100);
+
+    EXPECT_EQ(SendStatus::TooLarge, packetHandler.send(createPayload(MaxPacketSize + 1)));
+    EXPECT_EQ(SendStatus::Queued, packetHandler.send(createPayload(500)));
+    EXPECT_EQ(100, packetHandler.queueSpace(Priority::Normal));
+    EXPECT_EQ(SendStatus::QueueFull, packetHandler.send(createPayload(200)));
+
+    // control messages have own space
+    EXPECT_EQ(SendStatus::Queued, packetHandler.send(createPayload(50), Priority::High));
+    EXPECT_EQ(50, packetHandler.queueSpace(Priority::High));
+
+    // space is released when packet is completed
+    confirmPacket(*receiver, testingPort, createPayload(500));
+    EXPECT_EQ(600, packetHandler.queueSpace(Priority::Normal));
+    EXPECT_EQ(SendStatus::Queued, packetHandler.send(createPayload(200)));
+}
+
+TEST(PacketHandlerShould, ReportDroppedPacketInCompletion)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    packetHandler.setRetryLimit(0);
+    int completions = 0;
+    packetHandler.send(createPayload(10), Priority::Normal, [&completions](bool delivered) {
+        EXPECT_FALSE(delivered);
+        ++completions;
+    });
+
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 0, messages::Control::CrcChecksumFailed, {}),
+        defaultWriter);
+    EXPECT_EQ(1, completions);
+    EXPECT_EQ(MaxPacketSize, packetHandler.queueSpace(Priority::Normal));
+}
+
+TEST(PacketHandlerShould, QueuePacketsWithoutHeapAllocationInSteadyState)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    const auto payload = createPayload(1000);
+    // frame pool, queue and frame lists grow to cover two packets
+    for (int i = 0; i < 3; ++i)
+    {
+        packetHandler.send(payload);
+        packetHandler.send(payload);
+        confirmPacket(*receiver, testingPort, payload);
+        confirmPacket(*receiver, testingPort, payload);
+    }
+
+    // packet in flight arms retransmission timers, so only queueing of next one is measured
+    packetHandler.send(payload);
+    const u64 allocations = stub::allocation::count();
+    const auto status = packetHandler.send(payload);
+    const u64 allocationsAfterSend = stub::allocation::count();
+
+    EXPECT_EQ(SendStatus::Queued, status);
+    EXPECT_EQ(allocations, allocationsAfterSend);
+}
+
+TEST(PacketHandlerShould, TransmitFramesWithoutHeapAllocationInSteadyState)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::WheelManager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    const auto payload = createPayload(1000);
+    for (int i = 0; i < 3; ++i)
+    {
+        packetHandler.send(payload);
+        confirmPacket(*receiver, testingPort, payload);
+        timerManager.run();
+    }
+
+    // header frame goes out at once and arms its retransmission timer
+    const u64 allocations = stub::allocation::count();
+    const auto status = packetHandler.send(payload);
+    const u64 allocationsAfterSend = stub::allocation::count();
+
+    EXPECT_EQ(SendStatus::Queued, status);
+    EXPECT_EQ(allocations, allocationsAfterSend);
+    EXPECT_EQ(1u, timerManager.capacity() - timerManager.available());
+}
+
+TEST(PacketHandlerShould, SendFramesViewingSharedBuffer)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    const auto payload = createPayload(300);
+    const auto buffer = std::make_shared<const DataBuffer>(payload);
+    EXPECT_EQ(SendStatus::Queued, packetHandler.send(buffer));
+    EXPECT_EQ(2, buffer.use_count());
+
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    const auto firstFrame = helper::createFrame(payload, testingPort, 1, 0);
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(firstFrame.data(), firstFrame.size()));
+
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 1), defaultWriter);
+    const auto secondFrame = helper::createFrame(payload, testingPort, 2, MaxPayloadSize);
+    EXPECT_THAT(receiver->writeBuffer.data(),
+                ArrayCompare(secondFrame.data(), secondFrame.size()));
+
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 2), defaultWriter);
+    const auto crcFrame = helper::createCrc32Frame(testingPort, 3, payload);
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(crcFrame.data(), crcFrame.size()));
+
+    // buffer is released with the packet
+    receiver->readerCallback(helper::createAck(testingPort, 3), defaultWriter);
+    EXPECT_EQ(1, buffer.use_count());
+}
+
+TEST(PacketHandlerShould, PullStreamedPayloadAsWindowAdvances)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    agreeWindowSize(packetHandler, *receiver, testingPort, 2);
+    const auto payload = createPayload(800);
+    std::vector<std::size_t> pulled;
+    const auto producer = [&payload, &pulled](std::size_t offset, u8* data, u8 length) {
+        pulled.push_back(offset);
+        std::copy(&payload[offset], &payload[offset] + length, data);
+        return true;
+    };
+    bool delivered = false;
+    EXPECT_EQ(SendStatus::Queued,
+              packetHandler.send(payload.size(), producer, Priority::Normal,
+                                 [&delivered](bool result) { delivered = result; }));
+    EXPECT_EQ(MaxPacketSize - MaxPayloadSize, packetHandler.queueSpace(Priority::Normal));
+    EXPECT_TRUE(pulled.empty());
+
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    EXPECT_EQ((std::vector<std::size_t>{0, MaxPayloadSize}), pulled);
+    auto expected = helper::createFrame(payload, testingPort, 1, 0);
+    const auto second = helper::createFrame(payload, testingPort, 2, MaxPayloadSize);
+    expected.insert(expected.end(), second.begin(), second.end());
+    EXPECT_EQ(expected, receiver->writeBuffer);
+
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 1), defaultWriter);
+    EXPECT_EQ(3, pulled.size());
+    receiver->readerCallback(helper::createAck(testingPort, 2), defaultWriter);
+    EXPECT_EQ(4, pulled.size());
+    receiver->clearBuffers();
+    receiver->readerCallback(helper::createAck(testingPort, 3), defaultWriter);
+
+    // CRC-32 was accumulated while frames were produced
+    const auto crcFrame = helper::createCrc32Frame(testingPort, 5, payload);
+    EXPECT_THAT(receiver->writeBuffer.data(), ArrayCompare(crcFrame.data(), crcFrame.size()));
+    receiver->readerCallback(helper::createAck(testingPort, 4), defaultWriter);
+    receiver->readerCallback(helper::createAck(testingPort, 5), defaultWriter);
+    EXPECT_TRUE(delivered);
+}
+
+TEST(PacketHandlerShould, DropStreamedPacketWhenProducerFails)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    int completions = 0;
+    packetHandler.send(
+        1000, [](std::size_t offset, u8* /*data*/, u8 /*length*/) { return offset == 0; },
+        Priority::Normal, [&completions](bool delivered) {
+            EXPECT_FALSE(delivered);
+            ++completions;
+        });
+    const auto next = createPayload(10);
+    packetHandler.send(next);
+
+    confirmPacket(*receiver, testingPort, DataBuffer{});
+    EXPECT_EQ(1, completions);
+    // next packet goes on
+    const auto header = helper::createHeader(next, testingPort, 1, 0);
+    const auto lastWrite =
+        DataBuffer(receiver->writeBuffer.end() - header.size(), receiver->writeBuffer.end());
+    EXPECT_EQ(header, lastWrite);
+}
+
+TEST(PacketHandlerShould, RejectStreamedPacketsAboveQueueLimit)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    packetHandler.setQueueLimit(Priority::Normal, 2 * MaxPayloadSize);
+    const auto payload = createPayload(1000);
+    const auto producer = [&payload](std::size_t offset, u8* data, u8 length) {
+        std::copy(&payload[offset], &payload[offset] + length, data);
+        return true;
+    };
+
+    EXPECT_EQ(SendStatus::TooLarge, packetHandler.send(MaxPacketSize + 1, producer));
+    // each streamed packet is charged one frame of payload, whatever its size
+    EXPECT_EQ(SendStatus::Queued, packetHandler.send(payload.size(), producer));
+    EXPECT_EQ(SendStatus::Queued, packetHandler.send(payload.size(), producer));
+    EXPECT_EQ(0, packetHandler.queueSpace(Priority::Normal));
+    EXPECT_EQ(SendStatus::QueueFull, packetHandler.send(payload.size(), producer));
+
+    confirmPacket(*receiver, testingPort, payload);
+    EXPECT_EQ(MaxPayloadSize, packetHandler.queueSpace(Priority::Normal));
+    EXPECT_EQ(SendStatus::Queued, packetHandler.send(payload.size(), producer));
+}
+
+TEST(PacketHandlerShould, ConfirmFramesWithCumulativeAck)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    agreeWindowSize(packetHandler, *receiver, testingPort, 4);
+    bool delivered = false;
+    // 5 data frames and CRC frame
+    const auto testingPayload = createPayload(5 * MaxPayloadSize);
+    packetHandler.send(testingPayload, Priority::Normal,
+                       [&delivered](bool success) { delivered = success; });
+    receiver->readerCallback(helper::createAck(testingPort, 0), defaultWriter);
+    receiver->clearBuffers();
+
+    // frames 1, 2 and 4 confirmed, window moves past 2
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 1, messages::Control::CumulativeAck, {0x0b}),
+        defaultWriter);
+    EXPECT_EQ(2, receiver->writeCalls);
+    auto expectedFrames = helper::createFrame(testingPayload, testingPort, 5, 4 * MaxPayloadSize);
+    const auto crcFrame = helper::createCrc32Frame(testingPort, 6, testingPayload);
+    expectedFrames.insert(expectedFrames.end(), crcFrame.begin(), crcFrame.end());
+    EXPECT_EQ(expectedFrames, receiver->writeBuffer);
+
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 3, messages::Control::CumulativeAck, {0x0d}),
+        defaultWriter);
+    EXPECT_TRUE(delivered);
+}
+
+TEST(PacketHandlerShould, DeliverPacketsWithDelayedAcks)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto senderConnection(std::make_shared<stub::ReceiverStub>());
+    const auto receiverConnection(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+    PacketHandler sender(testingPort, senderConnection, timerManager);
+    PacketHandler receiver(testingPort, receiverConnection, timerManager);
+    receiver.setDelayedAck(8, 20);
+    std::vector<DataBuffer> packets;
+    receiver.setPacketReceiver([&packets](const BufferSpan& packet) {
+        packets.emplace_back(packet.begin(), packet.end());
+    });
+
+    const auto transfer = [](stub::ReceiverStub& from, stub::ReceiverStub& to) {
+        DataBuffer data;
+        data.swap(from.writeBuffer);
+        if (!data.empty())
+        {
+            to.readerCallback(data, defaultWriter);
+        }
+    };
+    std::size_t acks = 0;
+    const auto run = [&]() {
+        for (int i = 0; i < 100; ++i)
+        {
+            transfer(*senderConnection, *receiverConnection);
+            acks += receiverConnection->writeCalls;
+            receiverConnection->writeCalls = 0;
+            transfer(*receiverConnection, *senderConnection);
+            stub::time::forwardTime(5);
+            timerManager.run();
+        }
+    };
+    sender.setMaxWindowSize(8);
+    receiver.setMaxWindowSize(8);
+    sender.negotiateWindowSize();
+    run();
+    acks = 0;
+
+    // header, 6 data frames and CRC frame
+    const auto first = createPayload(6 * MaxPayloadSize);
+    const auto second = createPayload(10);
+    sender.send(first);
+    sender.send(second);
+    run();
+
+    ASSERT_EQ(2, packets.size());
+    EXPECT_EQ(first, packets[0]);
+    EXPECT_EQ(second, packets[1]);
+    // header is confirmed alone, rest of packet together when packet is complete
+    EXPECT_EQ(4, acks);
+}
+
+TEST(PacketHandlerShould, ShareLinkWithPacketHandlersOnOtherPorts)
+{
+    stub::time::setCurrentTime(0);
+    const u16 telemetryPort = 10;
+    const u16 firmwarePort = 11;
+    const auto senderConnection(std::make_shared<stub::ReceiverStub>());
+    const auto receiverConnection(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+    FrameHandler senderLink;
+    senderLink.setConnection(senderConnection);
+    // two full frames per pass, rest waits for acks
+    senderLink.setTransmitBurst(2 * (MaxPayloadSize + FrameOverhead));
+    FrameHandler receiverLink;
+    receiverLink.setConnection(receiverConnection);
+
+    PacketHandler telemetry(telemetryPort, senderLink, timerManager);
+    PacketHandler firmware(firmwarePort, senderLink, timerManager);
+    PacketHandler telemetryReceiver(telemetryPort, receiverLink, timerManager);
+    PacketHandler firmwareReceiver(firmwarePort, receiverLink, timerManager);
+    std::vector<std::pair<u16, DataBuffer>> packets;
+    telemetryReceiver.setPacketReceiver([&packets, telemetryPort](const BufferSpan& packet) {
+        packets.emplace_back(telemetryPort, DataBuffer(packet.begin(), packet.end()));
+    });
+    firmwareReceiver.setPacketReceiver([&packets, firmwarePort](const BufferSpan& packet) {
+        packets.emplace_back(firmwarePort, DataBuffer(packet.begin(), packet.end()));
+    });
+
+    const auto transfer = [](stub::ReceiverStub& from, stub::ReceiverStub& to) {
+        DataBuffer data;
+        data.swap(from.writeBuffer);
+        if (!data.empty())
+        {
+            to.readerCallback(data, defaultWriter);
+        }
+    };
+    const auto run = [&](int rounds) {
+        for (int i = 0; i < rounds; ++i)
+        {
+            transfer(*senderConnection, *receiverConnection);
+            transfer(*receiverConnection, *senderConnection);
+            stub::time::forwardTime(5);
+            timerManager.run();
+        }
+    };
+    for (auto* handler : {&telemetry, &firmware, &telemetryReceiver, &firmwareReceiver})
+    {
+        handler->setMaxWindowSize(8);
+    }
+    telemetry.negotiateWindowSize();
+    firmware.negotiateWindowSize();
+    run(10);
+
+    const auto image = createPayload(20 * MaxPayloadSize);
+    const auto reading = createPayload(10);
+    firmware.send(image);
+    run(3);
+    // telemetry doesn't wait until whole image is sent
+    telemetry.send(reading);
+    run(100);
+
+    ASSERT_EQ(2, packets.size());
+    EXPECT_EQ(telemetryPort, packets[0].first);
+    EXPECT_EQ(reading, packets[0].second);
+    EXPECT_EQ(firmwarePort, packets[1].first);
+    EXPECT_EQ(image, packets[1].second);
+}
+
+TEST(PacketHandlerShould, DeliverConsecutivePacketsThroughReceiveWindow)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto senderConnection(std::make_shared<stub::ReceiverStub>());
+    const auto receiverConnection(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+    FrameHandler senderLink;
+    senderLink.setConnection(senderConnection);
+    FrameHandler receiverLink;
+    receiverLink.setConnection(receiverConnection);
+
+    PacketHandler sender(testingPort, senderLink, timerManager);
+    PacketHandler receiver(testingPort, receiverLink, timerManager);
+    receiverLink.setReceiveWindow(testingPort, 8, FrameHandler::Numbering::PerPacket);
+    std::vector<DataBuffer> packets;
+    receiver.setPacketReceiver([&packets](const BufferSpan& packet) {
+        packets.emplace_back(packet.begin(), packet.end());
+    });
+
+    // every frame of sender comes twice, as if each ack was lost
+    const auto run = [&]() {
+        for (int i = 0; i < 100; ++i)
+        {
+            DataBuffer data;
+            data.swap(senderConnection->writeBuffer);
+            if (!data.empty())
+            {
+                receiverConnection->readerCallback(data, defaultWriter);
+                receiverConnection->readerCallback(data, defaultWriter);
+            }
+            data.clear();
+            data.swap(receiverConnection->writeBuffer);
+            if (!data.empty())
+            {
+                senderConnection->readerCallback(data, defaultWriter);
+            }
+            stub::time::forwardTime(5);
+            timerManager.run();
+        }
+    };
+
+    // frames of both packets are numbered from 0, second header falls behind the window
+    const auto first = createPayload(2 * MaxPayloadSize);
+    const auto second = createPayload(10);
+    sender.send(first);
+    sender.send(second);
+    run();
+
+    ASSERT_EQ(2, packets.size());
+    EXPECT_EQ(first, packets[0]);
+    EXPECT_EQ(second, packets[1]);
+    EXPECT_LT(0, receiverLink.duplicatesSuppressed());
+}
+
+namespace
+{
+
+DataBuffer credit(const u16 bytes)
+{
+    DataBuffer payload(sizeof(bytes));
+    serializer::serialize(payload.data(), bytes);
+    return payload;
+}
+
+} // namespace
+
+TEST(PacketHandlerShould, StopSendingWhenPeerCreditIsSpent)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    agreeWindowSize(packetHandler, *receiver, testingPort, 4);
+    EXPECT_FALSE(packetHandler.creditLimited());
+
+    // 3 data frames and CRC frame
+    const auto testingPayload = createPayload(3 * MaxPayloadSize);
+    packetHandler.send(testingPayload);
+    receiver->clearBuffers();
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 0, messages::Control::Success, credit(300)),
+        defaultWriter);
+    EXPECT_EQ(1, receiver->writeCalls);
+    EXPECT_TRUE(packetHandler.creditLimited());
+    EXPECT_EQ(300 - MaxPayloadSize, packetHandler.credit());
+    EXPECT_EQ(1, packetHandler.creditStalls());
+
+    // frame 1 is confirmed together with new credit
+    receiver->clearBuffers();
+    DataBuffer update = credit(600);
+    update.push_back(0x01);
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 1, messages::Control::CreditUpdate, update),
+        defaultWriter);
+    EXPECT_EQ(3, receiver->writeCalls);
+    EXPECT_EQ(600 - 2 * MaxPayloadSize - 4, packetHandler.credit());
+}
+
+TEST(PacketHandlerShould, RequestCreditWhenStalledWithoutFramesInFlight)
+{
+    stub::time::setCurrentTime(0);
+    const u16 testingPort = 10;
+    const auto receiver(std::make_shared<stub::ReceiverStub>());
+    timer::Manager timerManager;
+
+    PacketHandler packetHandler(testingPort, receiver, timerManager);
+    agreeWindowSize(packetHandler, *receiver, testingPort, 4);
+    const auto testingPayload = createPayload(MaxPayloadSize);
+    packetHandler.send(testingPayload);
+    receiver->clearBuffers();
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 0, messages::Control::Success, credit(0)),
+        defaultWriter);
+    EXPECT_EQ(0, receiver->writeCalls);
+
+    // update sent by peer when it freed its buffer may be lost
+    stub::time::forwardTime(packetHandler.rto() + 1);
+    timerManager.run();
+    const auto request =
+        helper::createControlFrame(testingPort, 0, messages::Control::CreditRequest, {});
+    EXPECT_EQ(request, receiver->writeBuffer);
+
+    receiver->clearBuffers();
+    receiver->readerCallback(
+        helper::createControlFrame(testingPort, 0, messages::Control::CreditUpdate, credit(1000)),
+        defaultWriter);
+    // data frame and CRC frame
+    EXPECT_EQ(2, receiver->writeCalls);
+
+    // no more requests once sender isn't stalled
+    receiver->readerCallback(helper::createAck(testingPort, 1), defaultWriter);
+    receiver->readerCallback(helper::createAck(testingPort, 2), defaultWriter);
+    receiver->clearBuffers();
+    stub::time::forwardTime(packetHandler.rto() + 1);
+    timerManager.run();
+    EXPECT_EQ(0, receiver->writeCalls);
+}
+
 }
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "protocol/receiveWindow.hpp"
+
+namespace protocol
+{
+
+TEST(ReceiveWindowShould, AcceptEverythingWhenDisabled)
+{
+    ReceiveWindow window;
+    EXPECT_TRUE(window.accept(1));
+    EXPECT_TRUE(window.accept(1));
+}
+
+TEST(ReceiveWindowShould, RejectFramesReceivedBefore)
+{
+    ReceiveWindow window(8);
+    EXPECT_TRUE(window.accept(10));
+    EXPECT_TRUE(window.accept(11));
+    EXPECT_FALSE(window.accept(10));
+    EXPECT_FALSE(window.accept(11));
+    EXPECT_TRUE(window.accept(12));
+    // frame sent before window moved
+    EXPECT_FALSE(window.accept(5));
+}
+
+TEST(ReceiveWindowShould, AcceptFramesOutOfOrderOnce)
+{
+    ReceiveWindow window(8);
+    EXPECT_TRUE(window.accept(0));
+    EXPECT_TRUE(window.accept(3));
+    EXPECT_TRUE(window.accept(2));
+    EXPECT_FALSE(window.accept(3));
+    EXPECT_TRUE(window.accept(1));
+    EXPECT_FALSE(window.accept(2));
+    EXPECT_TRUE(window.accept(4));
+}
+
+TEST(ReceiveWindowShould, HandleWraparoundOfNumbers)
+{
+    ReceiveWindow window(4);
+    EXPECT_TRUE(window.accept(254));
+    EXPECT_TRUE(window.accept(255));
+    EXPECT_TRUE(window.accept(1));
+    EXPECT_TRUE(window.accept(0));
+    EXPECT_FALSE(window.accept(255));
+    EXPECT_FALSE(window.accept(1));
+    EXPECT_TRUE(window.accept(2));
+}
+
+TEST(ReceiveWindowShould, FollowPeerWhichRestartedNumbering)
+{
+    ReceiveWindow window(4);
+    EXPECT_TRUE(window.accept(100));
+    EXPECT_TRUE(window.accept(101));
+    EXPECT_TRUE(window.accept(0));
+    EXPECT_TRUE(window.accept(1));
+    EXPECT_FALSE(window.accept(0));
+}
+
+TEST(ReceiveWindowShould, StartNewNumberingWhenRestarted)
+{
+    ReceiveWindow window(4);
+    EXPECT_TRUE(window.accept(0));
+    EXPECT_TRUE(window.accept(1));
+    window.restart();
+    EXPECT_TRUE(window.accept(0));
+    EXPECT_FALSE(window.accept(0));
+    EXPECT_TRUE(window.accept(1));
+}
+
+TEST(ReceiveWindowShould, ForgetHistoryWhenResized)
+{
+    ReceiveWindow window(4);
+    EXPECT_TRUE(window.accept(7));
+    window.resize(200);
+    EXPECT_EQ(ReceiveWindow::MaxSize, window.size());
+    EXPECT_TRUE(window.accept(7));
+    EXPECT_FALSE(window.accept(7));
+}
+
+} // namespace protocol
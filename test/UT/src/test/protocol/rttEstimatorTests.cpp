@@ -0,0 +1,77 @@
+#include "protocol/rttEstimator.hpp"
+
+#include <gtest/gtest.h>
+
+namespace protocol
+{
+
+TEST(RttEstimatorShould, StartWithInitialTimeout)
+{
+    RttEstimator estimator;
+    EXPECT_EQ(RttEstimator::InitialRto, estimator.rto());
+}
+
+TEST(RttEstimatorShould, InitializeFromFirstSample)
+{
+    RttEstimator estimator;
+    estimator.sample(100);
+
+    EXPECT_EQ(100, estimator.srtt());
+    EXPECT_EQ(50, estimator.rttvar());
+    EXPECT_EQ(300, estimator.rto());
+}
+
+TEST(RttEstimatorShould, SmoothSamples)
+{
+    RttEstimator estimator;
+    estimator.sample(100);
+    estimator.sample(180);
+
+    // SRTT = 7/8 * 100 + 1/8 * 180, RTTVAR = 3/4 * 50 + 1/4 * 80
+    EXPECT_EQ(110, estimator.srtt());
+    EXPECT_EQ(57, estimator.rttvar());
+    EXPECT_EQ(340, estimator.rto());
+}
+
+TEST(RttEstimatorShould, ConvergeToStableRoundTrip)
+{
+    RttEstimator estimator;
+    for (int i = 0; i < 100; ++i)
+    {
+        estimator.sample(40);
+    }
+
+    EXPECT_EQ(40, estimator.srtt());
+    EXPECT_GE(estimator.rto(), 40);
+    EXPECT_LT(estimator.rto(), 50);
+}
+
+TEST(RttEstimatorShould, KeepTimeoutInLimits)
+{
+    RttEstimator estimator(100, 1000);
+    estimator.sample(1);
+    EXPECT_EQ(100, estimator.rto());
+
+    estimator.sample(5000);
+    EXPECT_EQ(1000, estimator.rto());
+}
+
+TEST(RttEstimatorShould, BackoffExponentially)
+{
+    RttEstimator estimator(20, 2000);
+    estimator.sample(100);
+    EXPECT_EQ(300, estimator.rto());
+
+    estimator.backoff();
+    EXPECT_EQ(600, estimator.rto());
+    estimator.backoff();
+    EXPECT_EQ(1200, estimator.rto());
+    estimator.backoff();
+    EXPECT_EQ(2000, estimator.rto());
+
+    // new sample recalculates timeout
+    estimator.sample(100);
+    EXPECT_LT(estimator.rto(), 300);
+}
+
+} // namespace protocol
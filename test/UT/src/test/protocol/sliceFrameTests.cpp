@@ -0,0 +1,34 @@
+#include "protocol/sliceFrame.hpp"
+
+#include <gtest/gtest.h>
+
+namespace protocol
+{
+
+TEST(SliceFrameShould, ViewPayloadOfBuffer)
+{
+    const DataBuffer buffer{1, 2, 3, 4, 5, 6};
+    SliceFrame frame(&buffer[2], 3);
+    frame.port(1);
+    frame.number(2);
+    frame.control(0x20);
+
+    EXPECT_EQ(&buffer[2], frame.payload());
+    EXPECT_EQ(3, frame.length());
+    EXPECT_EQ(3, frame.payloadSize());
+    EXPECT_EQ(crc::Crc16Arc::calculate(BufferSpan{&buffer[2], 3}), frame.crc());
+    EXPECT_EQ(1, frame.port());
+    EXPECT_EQ(2, frame.number());
+    EXPECT_EQ(0x20, frame.control());
+}
+
+TEST(SliceFrameShould, NotAppendPayload)
+{
+    const DataBuffer buffer{1, 2, 3};
+    SliceFrame frame(buffer.data(), 3);
+
+    EXPECT_EQ(0, frame.payload(buffer.data(), 3));
+    EXPECT_EQ(3, frame.length());
+}
+
+} // namespace protocol
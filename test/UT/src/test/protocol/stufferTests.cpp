@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+
+#include "protocol/stuffer.hpp"
+
+namespace protocol
+{
+
+namespace
+{
+
+DataBuffer stuffed(const DataBuffer& data)
+{
+    DataBuffer output(maxStuffedSize(data.size()));
+    output.resize(stuff(data, output));
+    return output;
+}
+
+DataBuffer unstuffed(const DataBuffer& data)
+{
+    DataBuffer output(data.size());
+    output.resize(unstuff(data, output));
+    return output;
+}
+
+} // namespace
+
+TEST(StufferShould, ReplaceZerosWithDistanceToNextOne)
+{
+    EXPECT_EQ((DataBuffer{0x01}), stuffed({}));
+    EXPECT_EQ((DataBuffer{0x01, 0x01}), stuffed({0x00}));
+    EXPECT_EQ((DataBuffer{0x03, 0x11, 0x22, 0x02, 0x33}), stuffed({0x11, 0x22, 0x00, 0x33}));
+    EXPECT_EQ((DataBuffer{0x02, 0x11, 0x01, 0x01}), stuffed({0x11, 0x00, 0x00}));
+}
+
+TEST(StufferShould, SplitLongRunsWithoutZero)
+{
+    DataBuffer data(254);
+    std::iota(data.begin(), data.end(), 1);
+    DataBuffer expected{0xff};
+    expected.insert(expected.end(), data.begin(), data.end());
+    EXPECT_EQ(expected, stuffed(data));
+
+    data.push_back(0x42);
+    expected.push_back(0x02);
+    expected.push_back(0x42);
+    EXPECT_EQ(expected, stuffed(data));
+    EXPECT_EQ(maxStuffedSize(data.size()), stuffed(data).size());
+}
+
+TEST(StufferShould, RestoreOriginalData)
+{
+    for (const std::size_t size : {1, 253, 254, 255, 508, 1000})
+    {
+        for (const u8 zeroEvery : {1, 2, 7, 254, 255})
+        {
+            DataBuffer data(size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                data[i] = i % zeroEvery == 0 ? 0 : static_cast<u8>(i * 31 + 7) | 1;
+            }
+            const DataBuffer encoded = stuffed(data);
+            EXPECT_EQ(encoded.end(), std::find(encoded.begin(), encoded.end(), Delimiter));
+            EXPECT_LE(encoded.size(), maxStuffedSize(size));
+            EXPECT_EQ(data, unstuffed(encoded)) << size << " " << static_cast<int>(zeroEvery);
+        }
+    }
+}
+
+TEST(StufferShould, RejectMalformedData)
+{
+    DataBuffer output(8);
+    // code points past end of data
+    EXPECT_EQ(0, unstuff(DataBuffer{0x05, 0x11, 0x22}, output));
+    // delimiter inside stuffed data
+    EXPECT_EQ(0, unstuff(DataBuffer{0x02, 0x11, 0x00, 0x22}, output));
+}
+
+TEST(StufferShould, RejectTooSmallOutput)
+{
+    DataBuffer output(4);
+    EXPECT_EQ(0, stuff(DataBuffer{0x11, 0x22, 0x33, 0x44}, output));
+    EXPECT_EQ(0, unstuff(DataBuffer{0x03, 0x11, 0x22, 0x03, 0x33, 0x44}, output));
+}
+
+} // namespace protocol
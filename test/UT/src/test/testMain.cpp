@@ -2,6 +2,7 @@
 
 #include "logger/loggerConf.hpp"
 #include "logger/stdErrLogger.hpp"
+#include "stub/timeStub.hpp"
 
 int main(int argc, char** argv)
 {
@@ -10,6 +11,8 @@ int main(int argc, char** argv)
         logger::LoggerConf::get().add(logger::StdErrLogger{});
     }
 
+    // tests drive time by hand instead of waiting for steady clock
+    stub::time::setCurrentTime(0);
     ::testing::InitGoogleTest(&argc, argv);
 
     return RUN_ALL_TESTS();
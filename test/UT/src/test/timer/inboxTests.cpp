@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "timer/inbox.hpp"
+#include "timer/wheelManager.hpp"
+
+#include "stub/timeStub.hpp"
+
+namespace timer
+{
+
+namespace
+{
+std::atomic<int> wakeUps{0};
+
+void countWakeUp()
+{
+    ++wakeUps;
+}
+} // namespace
+
+TEST(InboxShould, RunPostedClosuresOnDrain)
+{
+    WheelManager timerManager;
+    Inbox inbox(timerManager);
+    std::vector<int> order;
+
+    EXPECT_TRUE(inbox.post([&order]() { order.push_back(1); }));
+    EXPECT_TRUE(inbox.post([&order]() { order.push_back(2); }));
+    EXPECT_TRUE(order.empty());
+
+    EXPECT_EQ(2, inbox.drain());
+    EXPECT_EQ((std::vector<int>{1, 2}), order);
+    EXPECT_EQ(0, inbox.drain());
+}
+
+TEST(InboxShould, ArmAndCancelTimersOnDrain)
+{
+    stub::time::setCurrentTime(0);
+    WheelManager timerManager;
+    Inbox inbox(timerManager);
+    int first = 0;
+    int second = 0;
+    Handle firstHandle;
+    Handle secondHandle;
+
+    EXPECT_TRUE(inbox.arm(10, [&first]() { ++first; }, &firstHandle));
+    EXPECT_TRUE(inbox.arm(10, [&second]() { ++second; }, &secondHandle));
+    EXPECT_FALSE(timerManager.armed(firstHandle));
+
+    EXPECT_EQ(2, inbox.drain());
+    EXPECT_TRUE(timerManager.armed(firstHandle));
+    EXPECT_TRUE(timerManager.armed(secondHandle));
+
+    EXPECT_TRUE(inbox.cancel(secondHandle));
+    EXPECT_EQ(1, inbox.drain());
+    EXPECT_FALSE(timerManager.armed(secondHandle));
+
+    stub::time::forwardTime(10);
+    timerManager.run();
+    EXPECT_EQ(1, first);
+    EXPECT_EQ(0, second);
+}
+
+TEST(InboxShould, RejectPostsWhenFull)
+{
+    WheelManager timerManager;
+    Inbox inbox(timerManager, 2);
+    int calls = 0;
+
+    EXPECT_TRUE(inbox.post([&calls]() { ++calls; }));
+    EXPECT_TRUE(inbox.post([&calls]() { ++calls; }));
+    EXPECT_FALSE(inbox.post([&calls]() { ++calls; }));
+
+    EXPECT_EQ(2, inbox.drain());
+    EXPECT_EQ(2, calls);
+}
+
+TEST(InboxShould, LeaveClosuresPostedDuringDrainForNextDrain)
+{
+    WheelManager timerManager;
+    Inbox inbox(timerManager);
+    int calls = 0;
+
+    inbox.post([&inbox, &calls]() {
+        ++calls;
+        inbox.post([&calls]() { ++calls; });
+    });
+
+    EXPECT_EQ(1, inbox.drain());
+    EXPECT_EQ(1, calls);
+    EXPECT_EQ(1, inbox.drain());
+    EXPECT_EQ(2, calls);
+}
+
+TEST(InboxShould, WakeOwnerOnlyOnFirstPostAfterDrain)
+{
+    WheelManager timerManager;
+    Inbox inbox(timerManager, Inbox::DefaultCapacity, &countWakeUp);
+    wakeUps = 0;
+
+    inbox.post([]() {});
+    inbox.post([]() {});
+    inbox.post([]() {});
+    EXPECT_EQ(1, wakeUps);
+
+    inbox.drain();
+    inbox.post([]() {});
+    EXPECT_EQ(2, wakeUps);
+}
+
+TEST(InboxShould, RunEveryClosurePostedFromManyThreads)
+{
+    const int Threads = 4;
+    const int PostsPerThread = 10000;
+    WheelManager timerManager;
+    Inbox inbox(timerManager, 32);
+    int calls = 0;
+
+    std::atomic<int> running{Threads};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < Threads; ++i)
+    {
+        threads.emplace_back([&inbox, &calls, &running]() {
+            for (int post = 0; post < PostsPerThread; ++post)
+            {
+                // counter is touched only by draining thread, so it needs no lock
+                while (!inbox.post([&calls]() { ++calls; }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+            --running;
+        });
+    }
+
+    while (running > 0)
+    {
+        inbox.drain();
+    }
+    inbox.drain();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(Threads * PostsPerThread, calls);
+}
+
+} // namespace timer
@@ -1,14 +1,34 @@
 #include <gtest/gtest.h>
 
+#include "hal/time/time.hpp"
 #include "timer/ITimer.hpp"
 #include "timer/manager.hpp"
+#include "timer/wheelManager.hpp"
 
 #include "stub/timeStub.hpp"
 
-TEST(ManagerShould, run)
+namespace
+{
+u64 clockMicroseconds = 0;
+
+u64 microsecondClock()
+{
+    return clockMicroseconds;
+}
+} // namespace
+
+template <typename T>
+class ManagerShould : public ::testing::Test
+{
+};
+
+using Managers = ::testing::Types<timer::Manager, timer::WheelManager>;
+TYPED_TEST_CASE(ManagerShould, Managers);
+
+TYPED_TEST(ManagerShould, run)
 {
     stub::time::setCurrentTime(100);
-    timer::Manager timerManager;
+    TypeParam timerManager;
 
     int timeout1Fires = 0;
     int timeout2Fires = 0;
@@ -130,3 +150,114 @@ TEST(ManagerShould, run)
     EXPECT_EQ(2, interval2Fires);
     EXPECT_EQ(0, interval3Fires);
 }
+
+TYPED_TEST(ManagerShould, ReportTimeToNextDeadline)
+{
+    stub::time::setCurrentTime(100);
+    TypeParam timerManager;
+    EXPECT_EQ(timer::NoDeadline, timerManager.timeToNextDeadline());
+
+    u64 firedAt = 0;
+    auto interval =
+        timerManager.setInterval(30, [&firedAt]() { firedAt = hal::time::milliseconds(); });
+    auto timeout = timerManager.setTimeout(5000, []() {});
+    EXPECT_LT(0u, timerManager.timeToNextDeadline());
+    EXPECT_GE(30u, timerManager.timeToNextDeadline());
+
+    // sleeping for reported time never oversleeps a deadline
+    for (const u64 deadline : {130, 160, 190})
+    {
+        while (0 == firedAt)
+        {
+            const u32 sleep = timerManager.timeToNextDeadline();
+            EXPECT_GE(deadline - hal::time::milliseconds(), sleep);
+            stub::time::forwardTime(sleep);
+            timerManager.run();
+        }
+        EXPECT_EQ(deadline, firedAt);
+        firedAt = 0;
+    }
+
+    interval->cancel();
+    stub::time::forwardTime(5000);
+    EXPECT_EQ(0u, timerManager.timeToNextDeadline());
+
+    timerManager.run();
+    EXPECT_FALSE(timeout->enabled());
+    EXPECT_EQ(timer::NoDeadline, timerManager.timeToNextDeadline());
+}
+
+TYPED_TEST(ManagerShould, CancelTimerByHandle)
+{
+    stub::time::setCurrentTime(100);
+    TypeParam timerManager;
+
+    int fired = 0;
+    timer::Handle kept = timerManager.arm(10, [&fired]() { ++fired; });
+    timer::Handle cancelled = timerManager.arm(10, [&fired]() { fired += 10; });
+    EXPECT_TRUE(timerManager.armed(kept));
+    EXPECT_TRUE(timerManager.armed(cancelled));
+
+    timerManager.cancel(cancelled);
+    EXPECT_FALSE(timerManager.armed(cancelled));
+    EXPECT_EQ(0u, cancelled.generation);
+
+    stub::time::forwardTime(10);
+    timerManager.run();
+    EXPECT_EQ(1, fired);
+    EXPECT_FALSE(timerManager.armed(kept));
+
+    // slot of expired timer is reused, stale handle doesn't reach the new timer
+    const timer::Handle stale = kept;
+    timer::Handle reused = timerManager.arm(10, [&fired]() { ++fired; });
+    timerManager.cancel(kept);
+    EXPECT_FALSE(timerManager.armed(stale));
+    EXPECT_TRUE(timerManager.armed(reused));
+
+    stub::time::forwardTime(10);
+    timerManager.run();
+    EXPECT_EQ(2, fired);
+}
+
+TYPED_TEST(ManagerShould, FireTimersNoEarlierThanRequested)
+{
+    clockMicroseconds = 10900;
+    hal::time::setClock(&microsecondClock);
+    TypeParam timerManager;
+
+    int fired = 0;
+    auto timeout = timerManager.setTimeout(5, [&fired]() { ++fired; });
+    clockMicroseconds = 15899;
+    hal::time::tick();
+    timerManager.run();
+    EXPECT_EQ(0, fired);
+
+    // reported sleep reaches the deadline, though it lies inside of a millisecond
+    EXPECT_EQ(1u, timerManager.timeToNextDeadline());
+    clockMicroseconds = 16000;
+    hal::time::tick();
+    timerManager.run();
+    EXPECT_EQ(1, fired);
+
+    stub::time::setCurrentTime(0);
+}
+
+TYPED_TEST(ManagerShould, RunTimersAtTimeOfLastTick)
+{
+    clockMicroseconds = 0;
+    hal::time::setClock(&microsecondClock);
+    TypeParam timerManager;
+
+    int fired = 0;
+    auto timeout = timerManager.setTimeout(10, [&fired]() { ++fired; });
+    clockMicroseconds = 10000;
+    timerManager.run();
+    EXPECT_EQ(0, fired);
+    EXPECT_EQ(0u, timerManager.timeToNextDeadline());
+
+    hal::time::tick();
+    timerManager.run();
+    EXPECT_EQ(1, fired);
+
+    stub::time::setCurrentTime(0);
+}
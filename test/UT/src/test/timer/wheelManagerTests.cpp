@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "timer/ITimer.hpp"
+#include "timer/manager.hpp"
+#include "timer/wheelManager.hpp"
+
+#include "stub/allocationCounter.hpp"
+#include "stub/timeStub.hpp"
+
+namespace timer
+{
+
+TEST(WheelManagerShould, FireTimersOnAllLevelsOnTime)
+{
+    // level boundaries, timers which must cascade and one beyond the last level
+    const std::vector<u32> timeouts = {1,    63,    64,     65,      4095,    4096,
+                                       4097, 70000, 262143, 3000000, 20000000};
+    stub::time::setCurrentTime(1000);
+    WheelManager timerManager;
+
+    std::vector<int> fires(timeouts.size(), 0);
+    for (std::size_t i = 0; i < timeouts.size(); ++i)
+    {
+        int& fired = fires[i];
+        timerManager.setTimeout(timeouts[i], [&fired]() { ++fired; });
+    }
+
+    for (std::size_t i = 0; i < timeouts.size(); ++i)
+    {
+        stub::time::setCurrentTime(1000 + timeouts[i] - 1);
+        timerManager.run();
+        EXPECT_EQ(0, fires[i]) << timeouts[i];
+
+        stub::time::forwardTime(1);
+        timerManager.run();
+        EXPECT_EQ(1, fires[i]) << timeouts[i];
+    }
+
+    stub::time::forwardTime(100000000);
+    timerManager.run();
+    for (const auto fired : fires)
+    {
+        EXPECT_EQ(1, fired);
+    }
+}
+
+TEST(WheelManagerShould, FireTimerWhichCrossesLevelBoundaryInOneRun)
+{
+    stub::time::setCurrentTime(4000);
+    WheelManager timerManager;
+
+    int fired = 0;
+    timerManager.setTimeout(200, [&fired]() { ++fired; });
+
+    stub::time::forwardTime(199);
+    timerManager.run();
+    EXPECT_EQ(0, fired);
+
+    stub::time::forwardTime(10000);
+    timerManager.run();
+    EXPECT_EQ(1, fired);
+}
+
+TEST(WheelManagerShould, ReleaseCancelledTimer)
+{
+    stub::time::setCurrentTime(0);
+    WheelManager timerManager;
+
+    auto captured = std::make_shared<int>(0);
+    auto timer = timerManager.setTimeout(5000, [captured]() { ++*captured; });
+    EXPECT_EQ(2, captured.use_count());
+
+    timer->cancel();
+    EXPECT_FALSE(timer->enabled());
+    timer.reset();
+    EXPECT_EQ(1, captured.use_count());
+
+    stub::time::forwardTime(5000);
+    timerManager.run();
+    EXPECT_EQ(0, *captured);
+}
+
+TEST(WheelManagerShould, KeepTimerWhosePointerWasDropped)
+{
+    stub::time::setCurrentTime(0);
+    WheelManager timerManager;
+
+    int fired = 0;
+    timerManager.setInterval(10, [&fired]() { ++fired; }, 3);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        stub::time::forwardTime(1);
+        timerManager.run();
+    }
+    EXPECT_EQ(3, fired);
+}
+
+TEST(WheelManagerShould, RunTimersSetByCallbackInNextRun)
+{
+    stub::time::setCurrentTime(0);
+    WheelManager timerManager;
+
+    int fired = 0;
+    timerManager.setTimeout(1, [&timerManager, &fired]() {
+        timerManager.setTimeout(0, [&fired]() { ++fired; });
+    });
+
+    stub::time::forwardTime(1);
+    timerManager.run();
+    EXPECT_EQ(0, fired);
+
+    timerManager.run();
+    EXPECT_EQ(1, fired);
+}
+
+TEST(WheelManagerShould, CancelIntervalFromItsCallback)
+{
+    stub::time::setCurrentTime(0);
+    WheelManager timerManager;
+
+    int fired = 0;
+    ITimer::TimerPtr interval;
+    interval = timerManager.setInterval(10, [&interval, &fired]() {
+        ++fired;
+        interval->cancel();
+    });
+
+    for (int i = 0; i < 10; ++i)
+    {
+        stub::time::forwardTime(10);
+        timerManager.run();
+    }
+    EXPECT_EQ(1, fired);
+    EXPECT_FALSE(interval->enabled());
+}
+
+TEST(WheelManagerShould, DisableTimersWhenDestroyed)
+{
+    stub::time::setCurrentTime(0);
+    ITimer::TimerPtr timer;
+    {
+        WheelManager timerManager;
+        timer = timerManager.setInterval(10, []() {});
+        EXPECT_TRUE(timer->enabled());
+    }
+    EXPECT_FALSE(timer->enabled());
+    timer->cancel();
+}
+
+TEST(WheelManagerShould, ArmAndFireTimersWithoutHeapAllocationInSteadyState)
+{
+    stub::time::setCurrentTime(0);
+    WheelManager timerManager(64);
+
+    int fired = 0;
+    std::vector<Handle> handles(64);
+    auto cycle = [&timerManager, &handles, &fired]() {
+        for (std::size_t i = 0; i < handles.size(); ++i)
+        {
+            handles[i] = timerManager.arm(static_cast<u32>(1 + i * 997 % 5000),
+                                          [&fired, &handles, i]() { fired += handles[i].index; });
+        }
+        // half is cancelled, as acknowledged frames cancel their retransmission
+        for (std::size_t i = 0; i < handles.size(); i += 2)
+        {
+            timerManager.cancel(handles[i]);
+        }
+        for (int tick = 0; tick < 5000; tick += 7)
+        {
+            stub::time::forwardTime(7);
+            timerManager.run();
+        }
+    };
+
+    cycle();
+    const u64 allocations = stub::allocation::count();
+    const int firedBefore = fired;
+    cycle();
+    cycle();
+
+    EXPECT_EQ(allocations, stub::allocation::count());
+    EXPECT_LT(firedBefore, fired);
+    EXPECT_EQ(64u, timerManager.capacity());
+    EXPECT_EQ(64u, timerManager.available());
+}
+
+TEST(WheelManagerShould, GrowWhenMoreTimersAreArmed)
+{
+    stub::time::setCurrentTime(0);
+    WheelManager timerManager(2);
+
+    int fired = 0;
+    for (int i = 0; i < 40; ++i)
+    {
+        timerManager.arm(5, [&fired]() { ++fired; });
+    }
+    EXPECT_LE(40u, timerManager.capacity());
+
+    stub::time::forwardTime(5);
+    timerManager.run();
+    EXPECT_EQ(40, fired);
+    EXPECT_EQ(timerManager.capacity(), timerManager.available());
+}
+
+TEST(WheelManagerShould, FireSameTimersAsManager)
+{
+    stub::time::setCurrentTime(12345);
+    Manager manager;
+    WheelManager wheel;
+    std::mt19937 random(7);
+    std::uniform_int_distribution<u32> timeout(0, 100000);
+    std::uniform_int_distribution<u32> step(0, 3000);
+    std::uniform_int_distribution<int> action(0, 9);
+
+    std::vector<int> managerFires(2000, 0);
+    std::vector<int> wheelFires(2000, 0);
+    std::vector<std::pair<ITimer::TimerPtr, ITimer::TimerPtr>> timers;
+    for (std::size_t i = 0; i < managerFires.size(); ++i)
+    {
+        const u32 milliseconds = timeout(random);
+        int& managerFired = managerFires[i];
+        int& wheelFired = wheelFires[i];
+        auto managerCallback = [&managerFired]() { ++managerFired; };
+        auto wheelCallback = [&wheelFired]() { ++wheelFired; };
+        const int kind = action(random);
+        if (0 == kind)
+        {
+            timers.emplace_back(manager.setInterval(milliseconds, managerCallback),
+                                wheel.setInterval(milliseconds, wheelCallback));
+        }
+        else if (1 == kind && !timers.empty())
+        {
+            timers.back().first->cancel();
+            timers.back().second->cancel();
+            timers.pop_back();
+        }
+        else
+        {
+            timers.emplace_back(manager.setTimeout(milliseconds, managerCallback),
+                                wheel.setTimeout(milliseconds, wheelCallback));
+        }
+
+        stub::time::forwardTime(step(random));
+        manager.run();
+        wheel.run();
+    }
+
+    EXPECT_LT(0, std::count(managerFires.begin(), managerFires.end(), 1));
+    EXPECT_EQ(managerFires, wheelFires);
+}
+
+} // namespace timer